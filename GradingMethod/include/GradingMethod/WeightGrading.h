@@ -10,6 +10,7 @@
 #ifndef GRADINGMETHOD_WEIGHTGRADING_H_
 #define GRADINGMETHOD_WEIGHTGRADING_H_
 
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -64,13 +65,26 @@ class WeightGrading : public Grading {
 
   typedef XRocData<float> XRocFloat;
 
-  float ProcessRect(XRocBBox &bbox);
-
-  float ProcessPose3d(XRocPose3D &pose3d);
-
-  float ProcessLmk(XRocLandmarks &lmk);
-
-  float ProcessQuality(XRocQuality &quality);
+  // grading inputs of one frame as structure of arrays
+  struct GradingBatch {
+    std::vector<float> size;
+    std::vector<float> pitch;
+    std::vector<float> yaw;
+    std::vector<float> lmk_score;
+    std::vector<float> quality;
+    std::vector<float> score;
+  };
+
+  // fill batch_ from the input lists, INVALID lists use default values
+  void Gather(const BaseDataVector &box_list,
+              const BaseDataVector &pose_3d_list,
+              const BaseDataVector &land_mark_list,
+              const BaseDataVector *quality_list);
+
+  // batch_.score of all items in one pass
+  void ComputeScores(bool with_quality);
+
+  GradingBatch batch_;
 
   std::shared_ptr<WeightGradingParam> config_param_;
 };
@@ -13,6 +13,8 @@
 #include <iostream>
 #include <memory>
 #include <cassert>
+#include <algorithm>
+#include <utility>
 
 #include "GradingMethod/WeightGrading.h"
 #include "json/json.h"
@@ -104,116 +106,119 @@ int WeightGrading::ProcessFrame(const std::vector<BaseDataPtr> &in,
   auto scores = std::make_shared<BaseDataVector>();
   out.push_back(std::static_pointer_cast<BaseData>(scores));
 
-  for (size_t i = 0; i < box_list->datas_.size(); i++) {
-    std::shared_ptr<XRocBBox> bbox;
-    std::shared_ptr<XRocPose3D> pose3d;
-    std::shared_ptr<XRocLandmarks> lmk;
-    if (box_list->state_ == DataState::INVALID) {
-      bbox = std::make_shared<XRocBBox>();
-    } else {
-      bbox = std::static_pointer_cast<XRocBBox>(box_list->datas_[i]);
-    }
-    if (pose_3d_list->state_ == DataState::INVALID) {
-      pose3d = std::make_shared<XRocPose3D>();
-    } else {
-      pose3d = std::static_pointer_cast<XRocPose3D>(pose_3d_list->datas_[i]);
-    }
-    if (land_mark_list->state_ == DataState::INVALID) {
-      lmk = std::make_shared<XRocLandmarks>();
-    } else {
-      lmk = std::static_pointer_cast<XRocLandmarks>(land_mark_list->datas_[i]);
-    }
+  Gather(*box_list, *pose_3d_list, *land_mark_list, quality_list.get());
+  ComputeScores(quality_list != nullptr);
 
-    std::shared_ptr<XRocFloat> score(new XRocFloat());
+  scores->datas_.resize(item_size);
+  for (size_t i = 0; i < item_size; i++) {
+    auto score = std::make_shared<XRocFloat>();
     score->type_ = "Number";
-
-    if (in.size() == 4) {
-      std::shared_ptr<XRocQuality> quality;
-      if (quality_list->state_ == DataState::INVALID) {
-        quality = std::make_shared<XRocQuality>();
-      } else {
-        quality = std::static_pointer_cast<XRocQuality>(quality_list->datas_[i]);
-      }
-      score->value = config_param_->size_weight * ProcessRect(*bbox)
-          + config_param_->pose_weight * ProcessPose3d(*pose3d)
-          + config_param_->lmk_weight * ProcessLmk(*lmk)
-          + config_param_->quality_weight * ProcessQuality(*quality);
-    } else {
-      score->value = config_param_->size_weight * ProcessRect(*bbox)
-          + config_param_->pose_weight * ProcessPose3d(*pose3d)
-          + config_param_->lmk_weight * ProcessLmk(*lmk);
-    }
-
-    LOGI << "score:" << score->value;
-    scores->datas_.push_back(score);
+    score->value = batch_.score[i];
+    LOGD << "score:" << score->value;
+    scores->datas_[i] = std::move(score);
   }
   return XROC_GRADING_OK;
 }
 
-float WeightGrading::ProcessRect(XRocBBox &bbox) {
-  auto w = bbox.value.Width();
-  auto h = bbox.value.Height();
-  float size = std::min(w, h);
-  float normalized_size = 0;
-  if (size < config_param_->size_min) {
-    normalized_size = 0;
-  } else if (size > config_param_->size_max) {
-    normalized_size = 1;
-  } else {
-    if (size > config_param_->size_inflexion)
-      normalized_size =
-          (size - config_param_->size_inflexion)
-              / (config_param_->size_max
-              - config_param_->size_inflexion) * 0.5f + 0.5f;
-    else
-      normalized_size =
-          (size - config_param_->size_min)
-              / (config_param_->size_inflexion
-              - config_param_->size_min) * 0.5f;
-  }
-  return normalized_size;
-}
-
-float WeightGrading::ProcessPose3d(XRocPose3D &pose3d) {
-  auto &pitch = pose3d.value.pitch;
-  auto &yaw = pose3d.value.yaw;
-  auto &roll = pose3d.value.roll;
-  if (yaw < -90) { yaw = -90; }
-  if (yaw > 90) { yaw = 90; }
-  if (pitch < -90) { pitch = -90; }
-  if (pitch > 90) { pitch = 90; }
-  float pos_frontal = (2000 - (yaw * yaw / 16 + pitch * pitch / 9) * 10);
-  if (pos_frontal < -1999) {
-    pos_frontal = -1999;
-  } else if (pos_frontal > 2000) {
-    pos_frontal = 2000;
+void WeightGrading::Gather(const BaseDataVector &box_list,
+                           const BaseDataVector &pose_3d_list,
+                           const BaseDataVector &land_mark_list,
+                           const BaseDataVector *quality_list) {
+  static const XRocBBox kEmptyBBox;
+  static const XRocPose3D kEmptyPose3D;
+  static const XRocLandmarks kEmptyLandmarks;
+  static const XRocQuality kEmptyQuality;
+
+  size_t item_size = box_list.datas_.size();
+  batch_.size.resize(item_size);
+  batch_.pitch.resize(item_size);
+  batch_.yaw.resize(item_size);
+  batch_.lmk_score.resize(item_size);
+  batch_.quality.resize(item_size);
+  batch_.score.resize(item_size);
+
+  bool box_valid = box_list.state_ != DataState::INVALID;
+  bool pose_valid = pose_3d_list.state_ != DataState::INVALID;
+  bool lmk_valid = land_mark_list.state_ != DataState::INVALID;
+  bool quality_valid =
+      quality_list && quality_list->state_ != DataState::INVALID;
+  for (size_t i = 0; i < item_size; i++) {
+    auto &bbox = box_valid
+        ? static_cast<const XRocBBox *>(box_list.datas_[i].get())->value
+        : kEmptyBBox.value;
+    auto &pose3d = pose_valid
+        ? static_cast<const XRocPose3D *>(pose_3d_list.datas_[i].get())->value
+        : kEmptyPose3D.value;
+    auto &lmk = lmk_valid
+        ? static_cast<const XRocLandmarks *>(
+              land_mark_list.datas_[i].get())->value
+        : kEmptyLandmarks.value;
+    batch_.size[i] = std::min(bbox.Width(), bbox.Height());
+    batch_.pitch[i] = pose3d.pitch;
+    batch_.yaw[i] = pose3d.yaw;
+    float lmk_score = 0;
+    for (auto &point : lmk.values) {
+      lmk_score += point.score;
+    }
+    batch_.lmk_score[i] = lmk_score;
+    if (quality_list) {
+      auto &quality = quality_valid
+          ? static_cast<const XRocQuality *>(
+                quality_list->datas_[i].get())->value
+          : kEmptyQuality.value;
+      batch_.quality[i] = quality.value;
+    }
   }
-  return (pos_frontal - config_param_->frontal_thr)
-      / (2000 - config_param_->frontal_thr);
 }
 
-float WeightGrading::ProcessLmk(XRocLandmarks &lmk) {
-  float normalized_lmk = 0;
-  for (auto &point : lmk.value.values) {
-    normalized_lmk += point.score;
+void WeightGrading::ComputeScores(bool with_quality) {
+  const float size_min = config_param_->size_min;
+  const float size_max = config_param_->size_max;
+  const float size_inflexion = config_param_->size_inflexion;
+  const float lower_range = size_inflexion - size_min;
+  const float upper_range = size_max - size_inflexion;
+  const float frontal_thr = config_param_->frontal_thr;
+  const float frontal_range = 2000 - frontal_thr;
+  const float lmk_divisor = config_param_->normalize_lmk_divisor;
+  const float size_weight = config_param_->size_weight;
+  const float pose_weight = config_param_->pose_weight;
+  const float lmk_weight = config_param_->lmk_weight;
+  const float quality_weight = with_quality ? config_param_->quality_weight : 0;
+
+  const float *size = batch_.size.data();
+  const float *pitch = batch_.pitch.data();
+  const float *yaw = batch_.yaw.data();
+  const float *lmk_score = batch_.lmk_score.data();
+  const float *quality = batch_.quality.data();
+  float *score = batch_.score.data();
+  size_t item_size = batch_.score.size();
+  // branch free so that the loop can be vectorized
+  for (size_t i = 0; i < item_size; i++) {
+    float s = size[i];
+    float size_grade = s > size_inflexion
+        ? (s - size_inflexion) / upper_range * 0.5f + 0.5f
+        : (s - size_min) / lower_range * 0.5f;
+    size_grade = s > size_max ? 1.0f : size_grade;
+    size_grade = s < size_min ? 0.0f : size_grade;
+
+    float y = std::min(std::max(yaw[i], -90.0f), 90.0f);
+    float p = std::min(std::max(pitch[i], -90.0f), 90.0f);
+    float pos_frontal = (2000 - (y * y / 16 + p * p / 9) * 10);
+    pos_frontal = std::min(std::max(pos_frontal, -1999.0f), 2000.0f);
+    float pose_grade = (pos_frontal - frontal_thr) / frontal_range;
+
+    float lmk_grade = lmk_score[i] / lmk_divisor;
+    lmk_grade = std::min(std::max(lmk_grade, 0.0f), 1.0f);
+
+    float value = size_weight * size_grade
+        + pose_weight * pose_grade
+        + lmk_weight * lmk_grade;
+    if (with_quality) {
+      float quality_grade = std::min(std::max(quality[i], 0.0f), 1.0f);
+      value += quality_weight * quality_grade;
+    }
+    score[i] = value;
   }
-  normalized_lmk /= config_param_->normalize_lmk_divisor;
-  if (normalized_lmk < 0)
-    normalized_lmk = 0;
-  if (normalized_lmk > 1)
-    normalized_lmk = 1;
-  return normalized_lmk;
-}
-
-float WeightGrading::ProcessQuality(XRocQuality &quality) {
-  float normalized_blur = 0;
-  if (quality.value.value < 0)
-      normalized_blur = 0;
-  else if (quality.value.value > 1)
-    normalized_blur = 1;
-  else
-    normalized_blur = quality.value.value;
-  return normalized_blur;
 }
 
 void WeightGrading::GradingFinalize() {}
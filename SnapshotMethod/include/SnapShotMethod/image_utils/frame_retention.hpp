@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief     frame_retention header
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.16
+ * @date      2026.10.19
+ */
+
+#ifndef SNAPSHOTMETHOD_IMAGE_UTILS_FRAME_RETENTION_HPP_
+#define SNAPSHOTMETHOD_IMAGE_UTILS_FRAME_RETENTION_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "SnapShotMethod/image_utils/snapshot_buffer_pool.hpp"
+#include "SnapShotMethod/snapshot_data_type/snapshot_data_type.hpp"
+
+namespace HobotXRoc {
+
+/**
+ * downscaled copy of an original frame, no longer counted as retained
+ */
+struct DownscaledImageFrame : public PooledCVImageFrame {
+  uint32_t downscale = 1;
+};
+
+/**
+ * Limits the original frames held by snaps through origin_image_frame
+ * (save_original_image_frame) and through crop_frame of a pending lazy
+ * crop. Frames exceeding the per-channel cap or the byte budget are
+ * downgraded oldest first, by time_stamp then frame_id (not by last use):
+ * origin_image_frame is replaced by a downscaled nv12 copy, or by a frame
+ * without image data when downscale is 0 or the frame can not be
+ * downscaled, and the pending crops of the frame are done.
+ */
+class FrameRetention {
+ public:
+  // budget_bytes and frames_per_channel of 0 are unlimited. The pending
+  // crops of downgraded frames are added to crops for the caller to do, or
+  // done here when crops is nullptr
+  void Limit(const std::vector<SelectSnapShotInfoPtr> &snaps,
+             uint64_t budget_bytes, unsigned frames_per_channel,
+             unsigned downscale,
+             std::vector<SelectSnapShotInfoPtr> *crops = nullptr);
+
+  // original frames held after the last Limit, once its crops are done
+  uint32_t PinnedFrames() const { return pinned_frames_; }
+  uint64_t PinnedBytes() const { return pinned_bytes_; }
+
+  static ImageFramePtr Downscale(const ImageFramePtr &frame,
+                                 unsigned downscale);
+
+ private:
+  uint32_t pinned_frames_ = 0;
+  uint64_t pinned_bytes_ = 0;
+};
+
+}  // namespace HobotXRoc
+
+#endif  // SNAPSHOTMETHOD_IMAGE_UTILS_FRAME_RETENTION_HPP_
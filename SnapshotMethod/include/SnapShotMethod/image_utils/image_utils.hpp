@@ -20,6 +20,8 @@ using hobot::vision::Points;
 using hobot::vision::BBox;
 typedef std::shared_ptr<hobot::vision::ImageFrame> ImageFramePtr;
 
+struct PooledCVImageFrame;
+
 class ImageUtils {
  public:
   static BBox AdjustSnapRect(const uint32_t &frame_width,
@@ -33,6 +35,27 @@ class ImageUtils {
                           uint8_t *data,
                           cv::Mat &cv_img);
 
+  // crop [x1, x1 + crop_width) x [y1, y1 + crop_height) of a nv12/nv21
+  // image, pad the part outside the image with black and bilinear scale it
+  // to dst_width x dst_height into dst (dst_width stride, uv follows y).
+  // x1, y1 and all sizes must be even
+  static void CropResizeNV12(const uint8_t *y_data, int y_stride,
+                             const uint8_t *uv_data, int uv_stride,
+                             int src_width, int src_height,
+                             int x1, int y1, int crop_width, int crop_height,
+                             int dst_width, int dst_height, uint8_t *dst);
+
+  // CropResizeNV12 of a nv12/nv21 frame into a pooled buffer wrapped by
+  // out->img, returns false if the frame or the sizes are not supported
+  static bool CropResizeFrame(const ImageFramePtr &frame,
+                              int x1, int y1,
+                              int crop_width, int crop_height,
+                              uint32_t dst_width, uint32_t dst_height,
+                              PooledCVImageFrame *out);
+
+  // CVImageFrame with the frame info of frame but no image data
+  static ImageFramePtr MetaImageFrame(const ImageFramePtr &frame);
+
   static ImageFramePtr DoFaceCrop(const ImageFramePtr &frame,
                                   const BBox &crop_rect,
                                   const uint32_t &output_width,
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief     snapshot buffer pool header
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.16
+ * @date      2026.10.19
+ */
+
+#ifndef SNAPSHOTMETHOD_IMAGE_UTILS_SNAPSHOT_BUFFER_POOL_HPP_
+#define SNAPSHOTMETHOD_IMAGE_UTILS_SNAPSHOT_BUFFER_POOL_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "horizon/vision_type/vision_type.hpp"
+#include "opencv2/core/core.hpp"
+
+namespace HobotXRoc {
+
+/**
+ * NV12 snapshot buffers keyed by resolution. A released buffer goes back to
+ * the free list of its resolution, at most max_free_per_size buffers are
+ * kept per resolution, the rest are freed.
+ */
+class SnapshotBufferPool {
+ public:
+  explicit SnapshotBufferPool(size_t max_free_per_size = 32);
+
+  static SnapshotBufferPool &Instance();
+
+  // width * height * 3 / 2 bytes, returned to the pool on release
+  std::shared_ptr<uint8_t> Acquire(uint32_t width, uint32_t height);
+
+  size_t FreeCount(uint32_t width, uint32_t height);
+
+  // Mat over buffer holding a reference to it, so that the buffer goes back
+  // to the pool only when the last copy of the Mat is released
+  static cv::Mat WrapMat(const std::shared_ptr<uint8_t> &buffer,
+                         int rows, int cols, int type);
+
+ private:
+  struct FreeLists {
+    explicit FreeLists(size_t max_free) : max_free_per_size(max_free) {}
+    ~FreeLists();
+    size_t max_free_per_size;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<uint8_t *>> free;
+  };
+
+  static uint64_t MakeKey(uint32_t width, uint32_t height) {
+    return (static_cast<uint64_t>(width) << 32) | height;
+  }
+
+  // buffers released after the pool is destroyed are freed directly
+  std::shared_ptr<FreeLists> lists_;
+};
+
+/**
+ * CVImageFrame whose img wraps a pooled buffer (SnapshotBufferPool::WrapMat),
+ * copies of img keep the buffer alive after the frame is released
+ */
+struct PooledCVImageFrame : public hobot::vision::CVImageFrame {
+  std::shared_ptr<uint8_t> buffer;
+};
+
+}  // namespace HobotXRoc
+
+#endif  // SNAPSHOTMETHOD_IMAGE_UTILS_SNAPSHOT_BUFFER_POOL_HPP_
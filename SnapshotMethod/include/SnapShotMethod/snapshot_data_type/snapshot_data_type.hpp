@@ -46,6 +46,16 @@ struct SelectSnapShotInfo: SnapshotInfoBaseData {
   float wide_scale = 0;
   float height_scale = 0;
   Points PointsToSnap(const Points &in) override;
+
+  // lazy_crop: the candidate keeps its source frame and crop rect, snap is
+  // only cropped by Crop() when the candidate is posted
+  ImageFramePtr crop_frame;
+  BBox crop_rect;
+  uint32_t output_width = 0;
+  uint32_t output_height = 0;
+  bool need_resize = true;
+  bool HasPendingCrop() const { return crop_frame != nullptr; }
+  void Crop();
 };
 
 #define SET_SNAPSHOT_METHOD_PARAM(json_cfg, type, key)          \
@@ -73,6 +83,8 @@ struct SnapShotParam : public InputParam {
   unsigned output_height = 0;
   bool snapshot_state_enable = false;
   bool save_original_image_frame = true;
+  bool lazy_crop = false;
+  unsigned crop_thread_num = 1;
   Json::Value config_jv;
   std::string Format() override;
 };
@@ -86,7 +98,8 @@ class SnapShotInfo {
       const float &select_score,
       const XRocBBoxPtr &pbbox,
       SnapShotParam *param,
-      std::vector<BaseDataPtr> userdatas);
+      std::vector<BaseDataPtr> userdatas,
+      bool defer_crop = false);
 
   static BaseDataVectorPtr GenerateSnapshotInfo(
       const std::vector<SelectSnapShotInfoPtr> &snap_infos,
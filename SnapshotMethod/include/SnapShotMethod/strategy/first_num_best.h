@@ -16,10 +16,13 @@
 #include <map>
 #include <memory>
 
+#include "common/task_group.h"
 #include "horizon/vision_type/vision_type.hpp"
 #include "SnapShotMethod/SnapShotMethod.h"
+#include "SnapShotMethod/image_utils/frame_retention.hpp"
 #include "SnapShotMethod/image_utils/image_utils.hpp"
 #include "SnapShotMethod/snapshot_data_type/snapshot_data_type.hpp"
+#include "SnapShotMethod/strategy/track_state_table.h"
 
 namespace HobotXRoc {
 
@@ -39,6 +42,10 @@ struct FirstNumBestParam : SnapShotParam {
   unsigned max_crop_num_per_frame = 0;
   unsigned smoothing_frame_range = 0;
   unsigned avg_crop_num_per_frame = 0;
+  unsigned max_retained_frames = 4;
+  unsigned origin_frame_budget_kb = 0;
+  unsigned origin_frames_per_channel = 0;
+  unsigned origin_frame_downscale = 4;
   uint64_t begin_post_frame_thr = 0;
   uint64_t resnap_value = 0;
   bool report_flushed_track_flag = false;
@@ -58,6 +65,15 @@ class FirstNumBest : public SnapShot {
 
   int UpdateParameter(const std::string &content) override;
 
+  // save_original_image_frame: original frames held by the candidates, as
+  // origin_image_frame or for a pending lazy crop, after the last frame
+  uint32_t PinnedOriginFrames() const {
+    return frame_retention_.PinnedFrames();
+  }
+  uint64_t PinnedOriginBytes() const {
+    return frame_retention_.PinnedBytes();
+  }
+
  private:
   struct State {
     uint64_t start_ = 0;
@@ -68,6 +84,13 @@ class FirstNumBest : public SnapShot {
 
   typedef std::shared_ptr<State> StatePtr;
 
+  // snapshot of snap_list slot index, generated once its crops are done
+  struct PostTarget {
+    std::vector<SelectSnapShotInfoPtr> snaps;
+    int32_t type;
+    size_t index;
+  };
+
   std::vector<BaseDataPtr> SelectAndPost(const std::vector<BaseDataPtr> &in);
 
   std::shared_ptr<FirstNumBestParam> GetConfig();
@@ -82,7 +105,7 @@ class FirstNumBest : public SnapShot {
 
   int UpdateCropHistory(uint32_t crop_count);
 
-  unsigned* GetSnapOrder(const BaseDataVectorPtr &bbox_list);
+  std::vector<unsigned> GetSnapOrder(const BaseDataVectorPtr &bbox_list);
 
   bool NeedReSnap(const float &frame_id, const StatePtr &track_state);
 
@@ -94,12 +117,32 @@ class FirstNumBest : public SnapShot {
                   const float &select_score,
                   const std::vector<BaseDataPtr> &userdatas);
 
-  std::map <int32_t, StatePtr> select_states_;
+  TrackStateTable<StatePtr> select_states_;
 
   std::list<unsigned> crop_history_;
 
   void UpdateResnapState(const uint64_t &frame_id);
 
+  // crop the pending candidates, on crop_thread_num threads
+  void CropSnaps(const std::vector<SelectSnapShotInfoPtr> &snaps);
+
+  // reserve a slot of snap_list for the snapshot of snaps
+  void AddPostTarget(const BaseDataVectorPtr &snap_list,
+                     const std::vector<SelectSnapShotInfoPtr> &snaps,
+                     int32_t type);
+
+  // crop all post targets together and fill their slots
+  void GeneratePostTargets(const BaseDataVectorPtr &snap_list);
+
+  // lazy_crop: crop the candidates of the oldest frames until at most
+  // max_retained_frames source frames are held by pending candidates
+  void LimitRetainedFrames();
+
+  // save_original_image_frame: downgrade the original frames held by snaps,
+  // and crop the pending candidates of the frames, beyond
+  // origin_frame_budget_kb / origin_frames_per_channel
+  void LimitOriginFrames();
+
   void PostSnapshot(const BaseDataVectorPtr &snap_list,
                     const BaseDataVectorPtr &bbox_list,
                     const uint64_t &frame_id);
@@ -110,6 +153,15 @@ class FirstNumBest : public SnapShot {
   void Reset() override;
 
   std::map<int32_t, SnapshotStatePtr> snapshot_state_;
+
+  // candidates selected in the current frame, cropped after selection
+  std::vector<SelectSnapShotInfoPtr> frame_crops_;
+
+  std::vector<PostTarget> post_targets_;
+
+  std::shared_ptr<TaskGroup> crop_workers_;
+
+  FrameRetention frame_retention_;
 };
 } // namespace HobotXRoc
 
@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief     track_state_table header
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.16
+ * @date      2026.10.19
+ */
+
+#ifndef SNAPSHOTMETHOD_STRATEGY_TRACK_STATE_TABLE_H_
+#define SNAPSHOTMETHOD_STRATEGY_TRACK_STATE_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace HobotXRoc {
+
+/**
+ * flat open addressing (linear probing) table of per-track values keyed by
+ * track id. The load factor is kept under 1/2, erase shifts the following
+ * entries back so no tombstone is needed. Iteration order is unspecified.
+ */
+template <typename Value>
+class TrackStateTable {
+ public:
+  explicit TrackStateTable(size_t max_size = 8) { Reserve(max_size); }
+
+  // rehash so that max_size entries fit without growing
+  void Reserve(size_t max_size) {
+    size_t capacity = 16;
+    while (capacity < max_size * 2) {
+      capacity <<= 1;
+    }
+    if (capacity > slots_.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  Value *Find(int32_t key) {
+    for (size_t i = Index(key);; i = (i + 1) & mask_) {
+      auto &slot = slots_[i];
+      if (!slot.used) {
+        return nullptr;
+      }
+      if (slot.key == key) {
+        return &slot.value;
+      }
+    }
+  }
+
+  // insert or overwrite
+  Value &Insert(int32_t key, Value value) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+      Rehash(slots_.size() * 2);
+    }
+    for (size_t i = Index(key);; i = (i + 1) & mask_) {
+      auto &slot = slots_[i];
+      if (!slot.used) {
+        slot.used = true;
+        slot.key = key;
+        slot.value = std::move(value);
+        size_++;
+        return slot.value;
+      }
+      if (slot.key == key) {
+        slot.value = std::move(value);
+        return slot.value;
+      }
+    }
+  }
+
+  bool Erase(int32_t key) {
+    size_t i = Index(key);
+    while (true) {
+      if (!slots_[i].used) {
+        return false;
+      }
+      if (slots_[i].key == key) {
+        break;
+      }
+      i = (i + 1) & mask_;
+    }
+    Release(&slots_[i]);
+    size_--;
+    // move back the entries whose probe sequence passes the hole
+    for (size_t j = (i + 1) & mask_; slots_[j].used; j = (j + 1) & mask_) {
+      size_t home = Index(slots_[j].key);
+      bool in_range = (i <= j) ? (home > i && home <= j)
+                               : (home > i || home <= j);
+      if (!in_range) {
+        slots_[i] = std::move(slots_[j]);
+        Release(&slots_[j]);
+        i = j;
+      }
+    }
+    return true;
+  }
+
+  // func(key, value&)
+  template <typename Func>
+  void ForEach(Func func) {
+    for (auto &slot : slots_) {
+      if (slot.used) {
+        func(slot.key, slot.value);
+      }
+    }
+  }
+
+  // erase the entries for which pred(key, value&) is true
+  template <typename Pred>
+  void EraseIf(Pred pred) {
+    std::vector<int32_t> keys;
+    ForEach([&](int32_t key, Value &value) {
+      if (pred(key, value)) {
+        keys.push_back(key);
+      }
+    });
+    for (auto key : keys) {
+      Erase(key);
+    }
+  }
+
+  void clear() {
+    for (auto &slot : slots_) {
+      Release(&slot);
+    }
+    size_ = 0;
+  }
+
+ private:
+  struct Slot {
+    bool used = false;
+    int32_t key = 0;
+    Value value{};
+  };
+
+  size_t Index(int32_t key) const {
+    return (static_cast<uint32_t>(key) * 2654435761u) & mask_;
+  }
+
+  static void Release(Slot *slot) {
+    slot->used = false;
+    slot->value = Value();
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<Slot> old;
+    old.swap(slots_);
+    slots_.resize(capacity);
+    mask_ = capacity - 1;
+    size_ = 0;
+    for (auto &slot : old) {
+      if (slot.used) {
+        Insert(slot.key, std::move(slot.value));
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace HobotXRoc
+
+#endif  // SNAPSHOTMETHOD_STRATEGY_TRACK_STATE_TABLE_H_
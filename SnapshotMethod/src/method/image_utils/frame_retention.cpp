@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief     frame_retention implementation
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.16
+ * @date      2026.10.19
+ */
+
+#include "SnapShotMethod/image_utils/frame_retention.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "hobotlog/hobotlog.hpp"
+#include "SnapShotMethod/image_utils/image_utils.hpp"
+
+namespace HobotXRoc {
+
+struct HeldFrame {
+  ImageFramePtr frame;
+  uint64_t bytes = 0;
+  // snaps holding the frame as origin_image_frame
+  std::vector<SelectSnapShotInfo *> users;
+  // snaps holding the frame for a pending lazy crop
+  std::vector<SelectSnapShotInfoPtr> croppers;
+};
+
+static bool IsOriginalFrame(const ImageFramePtr &frame) {
+  // frames without image data are already released
+  return frame && frame->Data()
+      && !std::dynamic_pointer_cast<DownscaledImageFrame>(frame);
+}
+
+void FrameRetention::Limit(const std::vector<SelectSnapShotInfoPtr> &snaps,
+                           uint64_t budget_bytes,
+                           unsigned frames_per_channel,
+                           unsigned downscale,
+                           std::vector<SelectSnapShotInfoPtr> *crops) {
+  std::vector<HeldFrame> held;
+  std::unordered_map<const hobot::vision::ImageFrame *, size_t> index;
+  auto hold = [&](const ImageFramePtr &frame) -> HeldFrame & {
+    auto iter = index.find(frame.get());
+    if (iter == index.end()) {
+      iter = index.emplace(frame.get(), held.size()).first;
+      held.emplace_back();
+      held.back().frame = frame;
+      held.back().bytes = frame->DataSize() + frame->DataUVSize();
+    }
+    return held[iter->second];
+  };
+  for (auto &snap : snaps) {
+    if (IsOriginalFrame(snap->origin_image_frame)) {
+      hold(snap->origin_image_frame).users.push_back(snap.get());
+    }
+    if (snap->HasPendingCrop() && IsOriginalFrame(snap->crop_frame)) {
+      hold(snap->crop_frame).croppers.push_back(snap);
+    }
+  }
+  // oldest first by capture time, how recently a snap used the frame does
+  // not matter
+  std::sort(held.begin(), held.end(),
+            [](const HeldFrame &a, const HeldFrame &b) {
+              if (a.frame->time_stamp != b.frame->time_stamp) {
+                return a.frame->time_stamp < b.frame->time_stamp;
+              }
+              return a.frame->frame_id < b.frame->frame_id;
+            });
+
+  std::vector<bool> release(held.size(), false);
+  if (frames_per_channel > 0) {
+    // keep the newest frames_per_channel frames of each channel
+    std::unordered_map<uint32_t, unsigned> channel_count;
+    for (size_t i = held.size(); i-- > 0;) {
+      if (++channel_count[held[i].frame->channel_id] > frames_per_channel) {
+        release[i] = true;
+      }
+    }
+  }
+  uint64_t total_bytes = 0;
+  for (size_t i = 0; i < held.size(); i++) {
+    if (!release[i]) {
+      total_bytes += held[i].bytes;
+    }
+  }
+  for (size_t i = 0; budget_bytes > 0 && total_bytes > budget_bytes
+                     && i < held.size(); i++) {
+    if (!release[i]) {
+      release[i] = true;
+      total_bytes -= held[i].bytes;
+    }
+  }
+
+  pinned_frames_ = 0;
+  pinned_bytes_ = 0;
+  for (size_t i = 0; i < held.size(); i++) {
+    auto &item = held[i];
+    if (!release[i]) {
+      pinned_frames_++;
+      pinned_bytes_ += item.bytes;
+      continue;
+    }
+    LOGD << "release origin frame " << item.frame->frame_id
+         << " of channel " << item.frame->channel_id
+         << ", held by " << item.users.size() << " snaps and "
+         << item.croppers.size() << " pending crops";
+    if (!item.users.empty()) {
+      auto copy = Downscale(item.frame, downscale);
+      if (!copy) {
+        copy = ImageUtils::MetaImageFrame(item.frame);
+      }
+      for (auto user : item.users) {
+        user->origin_image_frame = copy;
+      }
+    }
+    // a pending crop releases its frame once done
+    for (auto &cropper : item.croppers) {
+      if (crops) {
+        crops->push_back(cropper);
+      } else {
+        cropper->Crop();
+      }
+    }
+  }
+}
+
+ImageFramePtr FrameRetention::Downscale(const ImageFramePtr &frame,
+                                        unsigned downscale) {
+  if (downscale == 0) {
+    return nullptr;
+  }
+  uint32_t width = (frame->Width() / downscale) & ~1u;
+  uint32_t height = (frame->Height() / downscale) & ~1u;
+  if (width == 0 || height == 0) {
+    return nullptr;
+  }
+  std::shared_ptr<DownscaledImageFrame> copy(new DownscaledImageFrame());
+  if (!ImageUtils::CropResizeFrame(frame, 0, 0, frame->Width(),
+                                   frame->Height(), width, height,
+                                   copy.get())) {
+    return nullptr;
+  }
+  copy->downscale = downscale;
+  if (frame->pixel_format == kHorizonVisionPixelFormatRawNV21) {
+    copy->pixel_format = kHorizonVisionPixelFormatRawNV21;
+  } else {
+    copy->pixel_format = kHorizonVisionPixelFormatRawNV12;
+  }
+  copy->frame_id = frame->frame_id;
+  copy->time_stamp = frame->time_stamp;
+  copy->channel_id = frame->channel_id;
+  return copy;
+}
+
+}  // namespace HobotXRoc
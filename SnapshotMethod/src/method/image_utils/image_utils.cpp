@@ -7,10 +7,14 @@
  * @date      2019.04.22
  */
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <chrono>
+#include <vector>
 
 #include "SnapShotMethod/image_utils/image_utils.hpp"
+#include "SnapShotMethod/image_utils/snapshot_buffer_pool.hpp"
 #include "SnapShotMethod/error_code.h"
 #include "hobotlog/hobotlog.hpp"
 #include "hobotxsdk/xroc_data.h"
@@ -129,20 +133,148 @@ BBox ImageUtils::AdjustSnapRect(const uint32_t &frame_width,
   return out_bbox;
 }
 
-ImageFramePtr ImageUtils::DoFaceCrop(const ImageFramePtr &frame,
-                                     const BBox &crop_rect,
-                                     const uint32_t &output_width,
-                                     const uint32_t &output_height,
-                                     const bool &need_resize) {
-  if (!frame->Data())
-    return nullptr;
+// bilinear source taps of one output coordinate, index -1 is outside the
+// source image and reads the padding value
+struct ResizeTap {
+  int index0;
+  int index1;
+  int weight;  // Q8 weight of index1
+};
 
-  auto u32Width = static_cast<unsigned>(crop_rect.Width() + 1);
-  auto u32Height = static_cast<unsigned>(crop_rect.Height() + 1);
+static void GetResizeTaps(int crop_start, int crop_size, int src_size,
+                          int dst_size, std::vector<ResizeTap> *taps) {
+  taps->resize(dst_size);
+  float ratio = static_cast<float>(crop_size) / dst_size;
+  for (int i = 0; i < dst_size; i++) {
+    float pos = (i + 0.5f) * ratio - 0.5f;
+    pos = std::min(std::max(pos, 0.0f), static_cast<float>(crop_size - 1));
+    int pos0 = static_cast<int>(pos);
+    int pos1 = std::min(pos0 + 1, crop_size - 1);
+    auto &tap = (*taps)[i];
+    tap.weight = static_cast<int>((pos - pos0) * 256 + 0.5f);
+    tap.index0 = crop_start + pos0;
+    tap.index1 = crop_start + pos1;
+    if (tap.index0 < 0 || tap.index0 >= src_size) tap.index0 = -1;
+    if (tap.index1 < 0 || tap.index1 >= src_size) tap.index1 = -1;
+  }
+}
 
-  assert(u32Width == u32Height);
-  bool bNeedScale = (u32Width != output_width)
-      || (u32Height != output_height);
+// crop, pad and scale one plane of kChannels interleaved channels, sizes
+// and coordinates are in elements of the plane
+template <int kChannels>
+static void CropResizePlane(const uint8_t *src, int src_stride,
+                            int src_width, int src_height,
+                            int x1, int y1, int crop_width, int crop_height,
+                            int dst_width, int dst_height, uint8_t pad,
+                            uint8_t *dst) {
+  int dst_stride = dst_width * kChannels;
+  if (crop_width == dst_width && crop_height == dst_height) {
+    // no scale, copy the part inside the image and pad the rest
+    int left = std::min(std::max(-x1, 0), crop_width);
+    int right = std::min(std::max(x1 + crop_width - src_width, 0),
+                         crop_width - left);
+    int inside = crop_width - left - right;
+    for (int dy = 0; dy < dst_height; dy++) {
+      uint8_t *out = dst + dy * dst_stride;
+      int sy = y1 + dy;
+      if (sy < 0 || sy >= src_height || inside <= 0) {
+        memset(out, pad, dst_stride);
+        continue;
+      }
+      memset(out, pad, left * kChannels);
+      memcpy(out + left * kChannels,
+             src + sy * src_stride + (x1 + left) * kChannels,
+             inside * kChannels);
+      memset(out + (left + inside) * kChannels, pad, right * kChannels);
+    }
+    return;
+  }
+  thread_local std::vector<ResizeTap> x_taps;
+  thread_local std::vector<ResizeTap> y_taps;
+  GetResizeTaps(x1, crop_width, src_width, dst_width, &x_taps);
+  GetResizeTaps(y1, crop_height, src_height, dst_height, &y_taps);
+  for (int dy = 0; dy < dst_height; dy++) {
+    auto &y_tap = y_taps[dy];
+    const uint8_t *row0 =
+        y_tap.index0 < 0 ? nullptr : src + y_tap.index0 * src_stride;
+    const uint8_t *row1 =
+        y_tap.index1 < 0 ? nullptr : src + y_tap.index1 * src_stride;
+    int wy = y_tap.weight;
+    uint8_t *out = dst + dy * dst_stride;
+    for (int dx = 0; dx < dst_width; dx++) {
+      auto &x_tap = x_taps[dx];
+      int wx = x_tap.weight;
+      int off0 = x_tap.index0 * kChannels;
+      int off1 = x_tap.index1 * kChannels;
+      for (int c = 0; c < kChannels; c++) {
+        int p00 = (row0 && off0 >= 0) ? row0[off0 + c] : pad;
+        int p01 = (row0 && off1 >= 0) ? row0[off1 + c] : pad;
+        int p10 = (row1 && off0 >= 0) ? row1[off0 + c] : pad;
+        int p11 = (row1 && off1 >= 0) ? row1[off1 + c] : pad;
+        int top = p00 * (256 - wx) + p01 * wx;
+        int bottom = p10 * (256 - wx) + p11 * wx;
+        int value = (top * (256 - wy) + bottom * wy + 32768) >> 16;
+        out[dx * kChannels + c] = static_cast<uint8_t>(value);
+      }
+    }
+  }
+}
+
+void ImageUtils::CropResizeNV12(const uint8_t *y_data, int y_stride,
+                                const uint8_t *uv_data, int uv_stride,
+                                int src_width, int src_height,
+                                int x1, int y1, int crop_width, int crop_height,
+                                int dst_width, int dst_height, uint8_t *dst) {
+  // black in bt.601 video range
+  CropResizePlane<1>(y_data, y_stride, src_width, src_height,
+                     x1, y1, crop_width, crop_height,
+                     dst_width, dst_height, 16, dst);
+  CropResizePlane<2>(uv_data, uv_stride, src_width / 2, src_height / 2,
+                     x1 / 2, y1 / 2, crop_width / 2, crop_height / 2,
+                     dst_width / 2, dst_height / 2, 128,
+                     dst + dst_width * dst_height);
+}
+
+static bool IsNV12Layout(HorizonVisionPixelFormat format) {
+  return format == kHorizonVisionPixelFormatX2PYM
+      || format == kHorizonVisionPixelFormatX2SRC
+      || format == kHorizonVisionPixelFormatRawNV12
+      || format == kHorizonVisionPixelFormatRawNV21;
+}
+
+bool ImageUtils::CropResizeFrame(const ImageFramePtr &frame,
+                                 int x1, int y1,
+                                 int crop_width, int crop_height,
+                                 uint32_t dst_width, uint32_t dst_height,
+                                 PooledCVImageFrame *out) {
+  if (!IsNV12Layout(frame->pixel_format) || !frame->Data()
+      || frame->Width() == 0 || frame->Height() == 0
+      || x1 % 2 != 0 || y1 % 2 != 0
+      || crop_width % 2 != 0 || crop_height % 2 != 0
+      || dst_width % 2 != 0 || dst_height % 2 != 0) {
+    return false;
+  }
+  const uint8_t *y_data = frame->Data();
+  const uint8_t *uv_data = frame->DataUV();
+  if (!uv_data) {
+    // contiguous nv12 of CVImageFrame
+    uv_data = y_data + frame->Stride() * frame->Height();
+  }
+  out->buffer = SnapshotBufferPool::Instance().Acquire(dst_width, dst_height);
+  CropResizeNV12(y_data, frame->Stride(), uv_data, frame->StrideUV(),
+                 frame->Width(), frame->Height(), x1, y1,
+                 crop_width, crop_height, dst_width, dst_height,
+                 out->buffer.get());
+  out->img = SnapshotBufferPool::WrapMat(out->buffer, dst_height * 3 / 2,
+                                         dst_width, CV_8UC1);
+  return true;
+}
+
+// crop and scale with xroc-imagetools, for formats other than nv12/nv21
+static CVImageFramePtr DoImageToolsFaceCrop(const ImageFramePtr &frame,
+                                            const BBox &crop_rect,
+                                            uint32_t dst_width,
+                                            uint32_t dst_height) {
   int width = 0;
   int height = 0;
   int first_stride = 0;
@@ -150,7 +282,7 @@ ImageFramePtr ImageUtils::DoFaceCrop(const ImageFramePtr &frame,
   int crop_data_size = 0;
 
   unsigned char *pCropBuf = nullptr;
-  auto *output_format = new HobotXRocImageToolsPixelFormat();
+  HobotXRocImageToolsPixelFormat output_format;
 
   int s32Ret = HobotXRocCropImageFrameWithPaddingBlack(\
                        frame.get(),
@@ -158,68 +290,106 @@ ImageFramePtr ImageUtils::DoFaceCrop(const ImageFramePtr &frame,
                        static_cast<const int>(crop_rect.y1),
                        static_cast<const int>(crop_rect.x2),
                        static_cast<const int>(crop_rect.y2),
-                       output_format,
+                       &output_format,
                        &pCropBuf, &crop_data_size,
                        &width, &height,
                        &first_stride, &second_stride);
 
   if (s32Ret < 0) {
     LOGE << "crop failed!\n";
-    if (bNeedScale) {
-      std::free(pCropBuf);
-    }
+    std::free(pCropBuf);
     return nullptr;
   }
-  int out_data_size, out_stride, out_stride_uv;
   CVImageFramePtr snap_frame(new hobot::vision::CVImageFrame());
 
-  if (bNeedScale && need_resize) {
+  if (static_cast<uint32_t>(width) != dst_width
+      || static_cast<uint32_t>(height) != dst_height) {
     HobotXRocImageToolsResizeInfo resize_info {};
-    uint8_t *scale_data;
+    uint8_t *scale_data = nullptr;
+    int out_data_size, out_stride, out_stride_uv;
 
-    auto resize_start_time = high_resolution_clock::now();
     s32Ret = HobotXRocResizeImage(pCropBuf, crop_data_size,
                                   width, height,
                                   first_stride, second_stride,
-                                  *output_format,
+                                  output_format,
                                   1,
-                                  output_width,
-                                  output_height,
+                                  dst_width,
+                                  dst_height,
                                   &scale_data, &out_data_size,
                                   &out_stride,
                                   &out_stride_uv,
                                   &resize_info);
-
-    int cv_ret = ImageUtils::Data2CVImage(output_height,
-                                          output_width,
+    std::free(pCropBuf);
+    if (s32Ret < 0) {
+      LOGE << "hobot scale failed!\n";
+      std::free(scale_data);
+      return nullptr;
+    }
+    int cv_ret = ImageUtils::Data2CVImage(dst_height,
+                                          dst_width,
                                           frame->pixel_format,
                                           scale_data,
                                           snap_frame->img);
-
+    std::free(scale_data);
     if (cv_ret != XROC_SNAPSHOT_OK) {
       return nullptr;
     }
-
-    if (s32Ret < 0) {
-      LOGE << "hobot scale failed!\n";
-      std::free(pCropBuf);
-      return nullptr;
-    }
-    std::free(scale_data);
-    std::free(pCropBuf);
   } else {
     int cv_ret = ImageUtils::Data2CVImage(height,
                                           width,
                                           frame->pixel_format,
                                           pCropBuf,
                                           snap_frame->img);
+    std::free(pCropBuf);
     if (cv_ret != XROC_SNAPSHOT_OK) {
       return nullptr;
     }
-    std::free(pCropBuf);
   }
+  return snap_frame;
+}
 
-  delete output_format;
+ImageFramePtr ImageUtils::MetaImageFrame(const ImageFramePtr &frame) {
+  ImageFramePtr image_frame(new hobot::vision::CVImageFrame());
+  image_frame->frame_id = frame->frame_id;
+  image_frame->time_stamp = frame->time_stamp;
+  image_frame->pixel_format = frame->pixel_format;
+  image_frame->type = frame->type;
+  image_frame->channel_id = frame->channel_id;
+  return image_frame;
+}
+
+ImageFramePtr ImageUtils::DoFaceCrop(const ImageFramePtr &frame,
+                                     const BBox &crop_rect,
+                                     const uint32_t &output_width,
+                                     const uint32_t &output_height,
+                                     const bool &need_resize) {
+  if (!frame->Data())
+    return nullptr;
+
+  auto u32Width = static_cast<unsigned>(crop_rect.Width() + 1);
+  auto u32Height = static_cast<unsigned>(crop_rect.Height() + 1);
+
+  assert(u32Width == u32Height);
+  bool bNeedScale = (u32Width != output_width)
+      || (u32Height != output_height);
+  uint32_t dst_width = u32Width;
+  uint32_t dst_height = u32Height;
+  if (bNeedScale && need_resize) {
+    dst_width = output_width;
+    dst_height = output_height;
+  }
+
+  auto x1 = static_cast<int>(crop_rect.x1);
+  auto y1 = static_cast<int>(crop_rect.y1);
+  CVImageFramePtr snap_frame;
+  std::shared_ptr<PooledCVImageFrame> pooled_frame(new PooledCVImageFrame());
+  if (CropResizeFrame(frame, x1, y1, u32Width, u32Height,
+                      dst_width, dst_height, pooled_frame.get())) {
+    snap_frame = pooled_frame;
+  } else {
+    snap_frame = DoImageToolsFaceCrop(frame, crop_rect,
+                                      dst_width, dst_height);
+  }
 
   if (snap_frame) {
     if (frame->pixel_format == kHorizonVisionPixelFormatX2PYM
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief     snapshot buffer pool implementation
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.16
+ * @date      2026.10.19
+ */
+
+#include "SnapShotMethod/image_utils/snapshot_buffer_pool.hpp"
+
+namespace HobotXRoc {
+
+namespace {
+// the UMatData of a wrapped Mat holds a reference to the pooled buffer
+class PooledMatAllocator : public cv::MatAllocator {
+ public:
+  // a wrapped Mat recreated with another size gets ordinary memory
+  cv::UMatData *allocate(int dims, const int *sizes, int type, void *data,
+                         size_t *step, int flags,
+                         cv::UMatUsageFlags usage_flags) const override {
+    return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step,
+                                                flags, usage_flags);
+  }
+  bool allocate(cv::UMatData *data, int access_flags,
+                cv::UMatUsageFlags usage_flags) const override {
+    return cv::Mat::getStdAllocator()->allocate(data, access_flags,
+                                                usage_flags);
+  }
+  void deallocate(cv::UMatData *data) const override {
+    if (!data) {
+      return;
+    }
+    delete static_cast<std::shared_ptr<uint8_t> *>(data->userdata);
+    delete data;
+  }
+};
+}  // namespace
+
+SnapshotBufferPool::FreeLists::~FreeLists() {
+  for (auto &item : free) {
+    for (auto buf : item.second) {
+      delete[] buf;
+    }
+  }
+}
+
+SnapshotBufferPool::SnapshotBufferPool(size_t max_free_per_size)
+    : lists_(std::make_shared<FreeLists>(max_free_per_size)) {}
+
+SnapshotBufferPool &SnapshotBufferPool::Instance() {
+  static SnapshotBufferPool pool;
+  return pool;
+}
+
+std::shared_ptr<uint8_t> SnapshotBufferPool::Acquire(uint32_t width,
+                                                     uint32_t height) {
+  auto key = MakeKey(width, height);
+  uint8_t *buf = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(lists_->mutex);
+    auto &free = lists_->free[key];
+    if (!free.empty()) {
+      buf = free.back();
+      free.pop_back();
+    }
+  }
+  if (!buf) {
+    buf = new uint8_t[static_cast<size_t>(width) * height * 3 / 2];
+  }
+  std::weak_ptr<FreeLists> weak_lists = lists_;
+  return std::shared_ptr<uint8_t>(buf, [weak_lists, key](uint8_t *p) {
+    auto lists = weak_lists.lock();
+    if (lists) {
+      std::lock_guard<std::mutex> lock(lists->mutex);
+      auto &free = lists->free[key];
+      if (free.size() < lists->max_free_per_size) {
+        free.push_back(p);
+        return;
+      }
+    }
+    delete[] p;
+  });
+}
+
+cv::Mat SnapshotBufferPool::WrapMat(const std::shared_ptr<uint8_t> &buffer,
+                                    int rows, int cols, int type) {
+  // never destroyed, Mats may be released during static destruction
+  static PooledMatAllocator *allocator = new PooledMatAllocator();
+  cv::Mat mat(rows, cols, type, buffer.get());
+  auto u = new cv::UMatData(allocator);
+  u->data = u->origdata = buffer.get();
+  u->size = mat.total() * mat.elemSize();
+  u->refcount = 1;
+  u->userdata = new std::shared_ptr<uint8_t>(buffer);
+  mat.u = u;
+  mat.allocator = allocator;
+  return mat;
+}
+
+size_t SnapshotBufferPool::FreeCount(uint32_t width, uint32_t height) {
+  std::lock_guard<std::mutex> lock(lists_->mutex);
+  auto iter = lists_->free.find(MakeKey(width, height));
+  return iter == lists_->free.end() ? 0 : iter->second.size();
+}
+
+}  // namespace HobotXRoc
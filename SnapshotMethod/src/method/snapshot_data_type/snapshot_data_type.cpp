@@ -28,6 +28,15 @@ Points SelectSnapShotInfo::PointsToSnap(const Points &in) {
   return out;
 }
 
+void SelectSnapShotInfo::Crop() {
+  if (!crop_frame) {
+    return;
+  }
+  snap = ImageUtils::DoFaceCrop(crop_frame, crop_rect, output_width,
+                                output_height, need_resize);
+  crop_frame = nullptr;
+}
+
 int SnapShotParam::UpdateParameter(const std::string &content) {
   LOGD << "SnapShotParam update config: " << this;
   Json::CharReaderBuilder builder;
@@ -44,6 +53,8 @@ int SnapShotParam::UpdateParameter(const std::string &content) {
     SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, output_height);
     SET_SNAPSHOT_METHOD_PARAM(json_var, Bool, save_original_image_frame);
     SET_SNAPSHOT_METHOD_PARAM(json_var, Bool, snapshot_state_enable);
+    SET_SNAPSHOT_METHOD_PARAM(json_var, Bool, lazy_crop);
+    SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, crop_thread_num);
 
     LOGD << "scale_rate: " << scale_rate;
     LOGD << "need_resize: " << need_resize;
@@ -51,6 +62,8 @@ int SnapShotParam::UpdateParameter(const std::string &content) {
     LOGD << "output_height: " << output_height;
     LOGD << "save_original_image_frame: "
          << save_original_image_frame;
+    LOGD << "lazy_crop: " << lazy_crop;
+    LOGD << "crop_thread_num: " << crop_thread_num;
 
     if (ret) {
       return XROC_SNAPSHOT_OK;
@@ -70,20 +83,15 @@ SelectSnapShotInfoPtr SnapShotInfo::GetSnapShotInfo(const ImageFramePtr &frame,
                                       const float &select_score,
                                       const XRocBBoxPtr &pbbox,
                                       SnapShotParam* param,
-                                      std::vector<BaseDataPtr> userdatas) {
+                                      std::vector<BaseDataPtr> userdatas,
+                                      bool defer_crop) {
   SelectSnapShotInfoPtr snapshot_info(new SelectSnapShotInfo());
   snapshot_info->track_id = pbbox->value.id;
   snapshot_info->select_value = select_score;
   if (param->save_original_image_frame) {
     snapshot_info->origin_image_frame = frame;
   } else {
-    ImageFramePtr image_frame(new hobot::vision::CVImageFrame());
-    image_frame->frame_id = frame->frame_id;
-    image_frame->time_stamp = frame->time_stamp;
-    image_frame->pixel_format = frame->pixel_format;
-    image_frame->type = frame->type;
-    image_frame->channel_id = frame->channel_id;
-    snapshot_info->origin_image_frame = image_frame;
+    snapshot_info->origin_image_frame = ImageUtils::MetaImageFrame(frame);
   }
   auto &bbox = pbbox->value;
   auto ad_bbox = ImageUtils::AdjustSnapRect(
@@ -102,9 +110,14 @@ SelectSnapShotInfoPtr SnapShotInfo::GetSnapShotInfo(const ImageFramePtr &frame,
     snapshot_info->height_scale = 1;
   }
 
-  snapshot_info->snap =
-      ImageUtils::DoFaceCrop(frame, ad_bbox,
-          param->output_width, param->output_height, param->need_resize);
+  snapshot_info->crop_frame = frame;
+  snapshot_info->crop_rect = ad_bbox;
+  snapshot_info->output_width = param->output_width;
+  snapshot_info->output_height = param->output_height;
+  snapshot_info->need_resize = param->need_resize;
+  if (!param->lazy_crop && !defer_crop) {
+    snapshot_info->Crop();
+  }
   snapshot_info->userdata = std::move(userdatas);
   return snapshot_info;
 }
@@ -133,6 +146,8 @@ BaseDataVectorPtr SnapShotInfo::GenerateSnapshotInfo(
     const int32_t &type) {
   BaseDataVectorPtr snap_list(new BaseDataVector());
   for (auto &snap_info : snap_infos) {
+    // lazy_crop candidates are cropped once, when first posted
+    snap_info->Crop();
     XRocSnapshotInfoPtr xroc_snapshot_info(new XRocSnapshotInfo());
     xroc_snapshot_info->value = CopySelectSnapShotInfo(snap_info);
     xroc_snapshot_info->value->type = type;
@@ -145,9 +160,7 @@ BaseDataVectorPtr SnapShotInfo::GenerateSnapshotInfo(
 BaseDataPtr SnapShotInfo::GenerateWithoutSnapshot(
     const int32_t id) {
   XRocSnapshotInfoPtr xroc_snapshot_info(new XRocSnapshotInfo());
-  auto info = static_cast<SelectSnapShotInfo *>(
-      std::calloc(1, sizeof(SelectSnapShotInfo)));
-  SelectSnapShotInfoPtr cp_info(info);
+  SelectSnapShotInfoPtr cp_info(new SelectSnapShotInfo());
   cp_info->type = FLUSH_POST_TYPE;
   cp_info->track_id = id;
   xroc_snapshot_info->value = cp_info;
@@ -7,12 +7,18 @@
  * @date      2019.04.18
  */
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <ostream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "hobotxroc/profiler.h"
 #include "json/json.h"
 #include "SnapShotMethod/error_code.h"
@@ -28,6 +34,7 @@ typedef HobotXRoc::XRocData<ImageFramePtr> XRocImageFrame;
 
 int FirstNumBest::Init(std::shared_ptr<SnapShotParam> config) {
   snapshot_config_param_ = config;
+  select_states_.Reserve(GetConfig()->max_tracks);
   return XROC_SNAPSHOT_OK;
 }
 
@@ -95,7 +102,8 @@ int FirstNumBest::Select(const std::vector<BaseDataPtr> &in) {
   auto frame = std::static_pointer_cast<XRocImageFrame>(img_frame);
   unsigned crop_count = 0;
   int ret = 0;
-  auto *snap_order_map = GetSnapOrder(box_list);
+  frame_crops_.clear();
+  auto snap_order_map = GetSnapOrder(box_list);
   auto config_param = GetConfig();
   for (size_t i = 0; i < item_size; i++) {
     auto bbox =
@@ -116,7 +124,16 @@ int FirstNumBest::Select(const std::vector<BaseDataPtr> &in) {
     }
   }
   ret = UpdateCropHistory(crop_count);
-  delete[] snap_order_map;
+  if (config_param->lazy_crop) {
+    LimitRetainedFrames();
+  } else {
+    // selection is done, crop the new candidates of this frame together
+    CropSnaps(frame_crops_);
+  }
+  frame_crops_.clear();
+  if (config_param->save_original_image_frame) {
+    LimitOriginFrames();
+  }
   return ret;
 }
 
@@ -146,6 +163,8 @@ int FirstNumBest::Post(const std::vector<BaseDataPtr> &in,
   //  post the track whose snap count is reach to the begin_post_frame threshold
   PostSnapshot(snap_list, bbox_list, frame_id);
 
+  GeneratePostTargets(snap_list);
+
   // if satisfied re-snap condition, delete the track state
   UpdateResnapState(frame_id);
 
@@ -173,25 +192,22 @@ void FirstNumBest::FlushTheTrackState(const BaseDataVectorPtr &snap_list,
   for (const auto &data : flush_id_list->datas_) {
     auto track_id = std::static_pointer_cast<XRocUint32>(data);
     auto &id = track_id->value;
-    auto id_itr = select_states_.find(id);
+    auto *state_slot = select_states_.Find(id);
     if (config_param->IsVanishPostEnabled()) {
-      if (id_itr != select_states_.end()) {
-        auto &track_state = select_states_[id];
+      if (state_slot) {
+        auto track_state = *state_slot;
         if ((config_param->repeat_post_flag ||
              (!config_param->repeat_post_flag && !track_state->finish_)) &&
             (track_state->snaps_.size() >= config_param->snaps_per_track)) {
-          auto &snaps = select_states_[id]->snaps_;
+          auto &snaps = track_state->snaps_;
           HOBOT_CHECK(!snaps.empty())
               << "report_flushed_track_flag: "
               << config_param->report_flushed_track_flag
               << " out_date_target_post_flag: "
               << config_param->out_date_target_post_flag
               << " snaps_per_track: " << config_param->snaps_per_track;
-          auto one_target =
-              SnapShotInfo::GenerateSnapshotInfo(snaps, FLUSH_POST_TYPE);
-          HOBOT_CHECK(!one_target->datas_.empty());
-          snap_list->datas_.push_back(one_target);
-          select_states_.erase(id);
+          AddPostTarget(snap_list, snaps, FLUSH_POST_TYPE);
+          select_states_.Erase(id);
           continue;
         }
       }
@@ -199,8 +215,8 @@ void FirstNumBest::FlushTheTrackState(const BaseDataVectorPtr &snap_list,
         snap_list->datas_.push_back(SnapShotInfo::GenerateWithoutSnapshot(id));
       }
     }
-    if (id_itr != select_states_.end()) {
-      select_states_.erase(id);
+    if (state_slot) {
+      select_states_.Erase(id);
     }
   }
   if (config_param->IsVanishPostEnabled() &&
@@ -216,24 +232,22 @@ void FirstNumBest::PostSnapshot(const BaseDataVectorPtr &snap_list,
   for (const auto &data : bbox_list->datas_) {
     auto bbox = std::static_pointer_cast<XRocBBox>(data);
     auto &id = bbox->value.id;
-    if (!select_states_.count(id)) {
+    auto *state_slot = select_states_.Find(id);
+    if (!state_slot) {
       LOGI << "id: " << id << " is not in select_states";
       continue;
     }
 
-    auto &track_state = select_states_[id];
+    auto &track_state = *state_slot;
     if (!track_state->finish_ && ReadyToPost(track_state) &&
         track_state->snaps_.size() >= config_param->snaps_per_track) {
       if (config_param->out_date_target_post_flag ||
           (!config_param->out_date_target_post_flag &&
            data->state_ == DataState::VALID)) {
-        auto &snaps = select_states_[id]->snaps_;
+        auto &snaps = track_state->snaps_;
         HOBOT_CHECK(!snaps.empty())
             << "snaps_per_track: " << config_param->snaps_per_track;
-        auto one_target =
-            SnapShotInfo::GenerateSnapshotInfo(snaps, READY_POST_TYPE);
-        HOBOT_CHECK(!one_target->datas_.empty());
-        snap_list->datas_.push_back(one_target);
+        AddPostTarget(snap_list, snaps, READY_POST_TYPE);
       }
       if (config_param->snapshot_state_enable) {
         if (snapshot_state_.find(id) == snapshot_state_.end()) {
@@ -258,10 +272,7 @@ void FirstNumBest::PostSnapshot(const BaseDataVectorPtr &snap_list,
 
 void FirstNumBest::UpdateResnapState(const uint64_t &frame_id) {
   auto config_param = GetConfig();
-  auto iter = select_states_.begin();
-  while (iter != select_states_.end()) {
-    auto id = iter->first;
-    auto &track_state = iter->second;
+  select_states_.EraseIf([&](int32_t id, StatePtr &track_state) {
     if (NeedReSnap(frame_id, track_state)) {
       if (config_param->snapshot_state_enable) {
         if (snapshot_state_.find(id) == snapshot_state_.end()) {
@@ -278,59 +289,122 @@ void FirstNumBest::UpdateResnapState(const uint64_t &frame_id) {
                << " Snap repeat:" << (SnapState->snap_repeat? 1 : 0);
         }
       }
-      iter = select_states_.erase(iter);
-    } else {
-      iter++;
+      return true;
+    }
+    return false;
+  });
+}
+
+void FirstNumBest::CropSnaps(const std::vector<SelectSnapShotInfoPtr> &snaps) {
+  auto config_param = GetConfig();
+  int thread_num = std::max(1u, config_param->crop_thread_num);
+  if (!crop_workers_ || crop_workers_->ThreadNum() != thread_num) {
+    crop_workers_ = std::make_shared<TaskGroup>(thread_num);
+  }
+  std::unordered_set<SelectSnapShotInfo *> added;
+  std::vector<std::function<void()>> tasks;
+  for (auto &snap : snaps) {
+    auto info = snap.get();
+    if (info->HasPendingCrop() && added.insert(info).second) {
+      tasks.emplace_back([info] { info->Crop(); });
     }
   }
+  crop_workers_->Run(tasks);
 }
 
-unsigned *FirstNumBest::GetSnapOrder(const BaseDataVectorPtr &bbox_list) {
-  auto *snap_order_map = new unsigned[bbox_list->datas_.size()];
-  auto *new_resps_order_map = new unsigned[bbox_list->datas_.size()];
-  auto *old_resps_order_map = new unsigned[bbox_list->datas_.size()];
-  int new_resps_count = 0;
-  unsigned old_resps_count = 0;
-  for (unsigned i = 0; i < bbox_list->datas_.size(); i++) {
-    auto bbox = std::static_pointer_cast<XRocBBox>(bbox_list->datas_[i]);
-    auto id = static_cast<unsigned>(bbox->value.id);
-    if (select_states_.find(id) != select_states_.end()) {
-      old_resps_order_map[old_resps_count] = i;
-      for (int j = old_resps_count; j > 0; j--) {
-        auto bbox1 = std::static_pointer_cast<XRocBBox>(
-            bbox_list->datas_[old_resps_order_map[j]]);
-        auto bbox2 = std::static_pointer_cast<XRocBBox>(
-            bbox_list->datas_[old_resps_order_map[j - 1]]);
-        if (bbox1->value.y2 > bbox2->value.y2) {
-          auto tmp = old_resps_order_map[j];
-          old_resps_order_map[j] = old_resps_order_map[j - 1];
-          old_resps_order_map[j - 1] = tmp;
-        }
-      }
-      old_resps_count++;
-    } else {
-      new_resps_order_map[new_resps_count] = i;
-      for (int j = new_resps_count; j > 0; j--) {
-        auto bbox1 = std::static_pointer_cast<XRocBBox>(
-            bbox_list->datas_[new_resps_order_map[j]]);
-        auto bbox2 = std::static_pointer_cast<XRocBBox>(
-            bbox_list->datas_[new_resps_order_map[j - 1]]);
-        if (bbox1->value.y2 > bbox2->value.y2) {
-          auto tmp = new_resps_order_map[j];
-          new_resps_order_map[j] = new_resps_order_map[j - 1];
-          new_resps_order_map[j - 1] = tmp;
-        }
+void FirstNumBest::AddPostTarget(
+    const BaseDataVectorPtr &snap_list,
+    const std::vector<SelectSnapShotInfoPtr> &snaps, int32_t type) {
+  PostTarget target;
+  target.snaps = snaps;
+  target.type = type;
+  target.index = snap_list->datas_.size();
+  post_targets_.push_back(std::move(target));
+  snap_list->datas_.push_back(nullptr);
+}
+
+void FirstNumBest::GeneratePostTargets(const BaseDataVectorPtr &snap_list) {
+  std::vector<SelectSnapShotInfoPtr> snaps;
+  for (auto &target : post_targets_) {
+    snaps.insert(snaps.end(), target.snaps.begin(), target.snaps.end());
+  }
+  CropSnaps(snaps);
+  for (auto &target : post_targets_) {
+    auto one_target =
+        SnapShotInfo::GenerateSnapshotInfo(target.snaps, target.type);
+    HOBOT_CHECK(!one_target->datas_.empty());
+    snap_list->datas_[target.index] = one_target;
+  }
+  post_targets_.clear();
+}
+
+void FirstNumBest::LimitRetainedFrames() {
+  auto config_param = GetConfig();
+  // pending candidates grouped by the source frame, oldest frame first
+  std::map<std::pair<uint64_t, const hobot::vision::ImageFrame *>,
+           std::vector<SelectSnapShotInfoPtr>> pending;
+  select_states_.ForEach([&](int32_t id, StatePtr &state) {
+    for (auto &snap : state->snaps_) {
+      if (snap->HasPendingCrop()) {
+        auto &frame = snap->crop_frame;
+        pending[std::make_pair(frame->frame_id, frame.get())].push_back(snap);
       }
-      new_resps_count++;
     }
+  });
+  std::vector<SelectSnapShotInfoPtr> snaps;
+  auto iter = pending.begin();
+  while (pending.size() > config_param->max_retained_frames) {
+    LOGD << "crop pending snaps of frame " << iter->first.first;
+    snaps.insert(snaps.end(), iter->second.begin(), iter->second.end());
+    iter = pending.erase(iter);
+  }
+  CropSnaps(snaps);
+}
+
+void FirstNumBest::LimitOriginFrames() {
+  auto config_param = GetConfig();
+  std::vector<SelectSnapShotInfoPtr> snaps;
+  select_states_.ForEach([&](int32_t id, StatePtr &state) {
+    snaps.insert(snaps.end(), state->snaps_.begin(), state->snaps_.end());
+  });
+  std::vector<SelectSnapShotInfoPtr> crops;
+  frame_retention_.Limit(
+      snaps, static_cast<uint64_t>(config_param->origin_frame_budget_kb) << 10,
+      config_param->origin_frames_per_channel,
+      config_param->origin_frame_downscale, &crops);
+  CropSnaps(crops);
+  LOGD << "pinned origin frames: " << PinnedOriginFrames()
+       << ", bytes: " << PinnedOriginBytes();
+}
+
+std::vector<unsigned> FirstNumBest::GetSnapOrder(
+    const BaseDataVectorPtr &bbox_list) {
+  // new tracks before old tracks, then lower boxes (larger y2) first, then
+  // input order
+  struct OrderKey {
+    bool is_old;
+    float y2;
+    unsigned index;
+  };
+  size_t item_size = bbox_list->datas_.size();
+  std::vector<OrderKey> keys(item_size);
+  for (unsigned i = 0; i < item_size; i++) {
+    auto bbox = static_cast<XRocBBox *>(bbox_list->datas_[i].get());
+    keys[i].is_old = select_states_.Find(bbox->value.id) != nullptr;
+    keys[i].y2 = bbox->value.y2;
+    keys[i].index = i;
+  }
+  std::sort(keys.begin(), keys.end(),
+            [](const OrderKey &a, const OrderKey &b) {
+              if (a.is_old != b.is_old) return !a.is_old;
+              if (a.y2 != b.y2) return a.y2 > b.y2;
+              return a.index < b.index;
+            });
+  std::vector<unsigned> snap_order(item_size);
+  for (size_t i = 0; i < item_size; i++) {
+    snap_order[i] = keys[i].index;
   }
-  memcpy(snap_order_map, new_resps_order_map,
-         sizeof(unsigned) * new_resps_count);
-  memcpy(snap_order_map + new_resps_count, old_resps_order_map,
-         sizeof(unsigned) * old_resps_count);
-  delete[] new_resps_order_map;
-  delete[] old_resps_order_map;
-  return snap_order_map;
+  return snap_order;
 }
 
 int FirstNumBest::UpdateState(const ImageFramePtr &frame, uint32_t &crop_count,
@@ -344,11 +418,13 @@ int FirstNumBest::UpdateState(const ImageFramePtr &frame, uint32_t &crop_count,
 
   if ((pbbox->state_ == DataState::VALID ||
        pbbox->state_ == DataState::FILTERED)) {
-    if (select_states_.find(id) == select_states_.end()) {
+    auto *state_slot = select_states_.Find(id);
+    if (!state_slot) {
       ret = AddNewTrackState(id, frame->frame_id);
       if (ret != XROC_SNAPSHOT_OK) return ret;
+      state_slot = select_states_.Find(id);
     }
-    auto &state = select_states_[id];
+    auto state = *state_slot;
     state->count_++;
     auto config_param = GetConfig();
     if (crop_count < config_param->max_crop_num_per_frame &&
@@ -358,10 +434,12 @@ int FirstNumBest::UpdateState(const ImageFramePtr &frame, uint32_t &crop_count,
       if (pbbox->state_ == DataState::VALID) {
         if (state->snaps_.empty() ||
             state->snaps_.size() < config_param->snaps_per_track) {
-          select_states_[id]->snaps_.push_back(SnapShotInfo::GetSnapShotInfo(
-              frame, select_score, pbbox, config_param.get(), userdatas));
+          state->snaps_.push_back(SnapShotInfo::GetSnapShotInfo(
+              frame, select_score, pbbox, config_param.get(), userdatas,
+              true));
+          frame_crops_.push_back(state->snaps_.back());
           if (config_param->snapshot_state_enable
-              && !select_states_[id]->finish_) {
+              && !state->finish_) {
             SnapshotStatePtr SnapState(new SnapshotState());
             SnapState->id = id;
             SnapState->box = pbbox->value;
@@ -374,8 +452,8 @@ int FirstNumBest::UpdateState(const ImageFramePtr &frame, uint32_t &crop_count,
           }
           crop_count++;
         } else {
-          HOBOT_CHECK(!select_states_[id]->snaps_.empty());
-          auto &snaps = select_states_[id]->snaps_;
+          HOBOT_CHECK(!state->snaps_.empty());
+          auto &snaps = state->snaps_;
           auto min_select_value = snaps[0]->select_value;
           size_t min_select_value_index = 0;
           for (size_t i = 0; i < snaps.size(); i++) {
@@ -386,9 +464,11 @@ int FirstNumBest::UpdateState(const ImageFramePtr &frame, uint32_t &crop_count,
           }
           if (min_select_value + config_param->update_steps < select_score) {
             snaps[min_select_value_index] = SnapShotInfo::GetSnapShotInfo(
-                frame, select_score, pbbox, config_param.get(), userdatas);
+                frame, select_score, pbbox, config_param.get(), userdatas,
+                true);
+            frame_crops_.push_back(snaps[min_select_value_index]);
             if (config_param->snapshot_state_enable
-                && !select_states_[id]->finish_) {
+                && !state->finish_) {
               SnapshotStatePtr SnapState(new SnapshotState());
               SnapState->id = id;
               SnapState->box = pbbox->value;
@@ -428,7 +508,7 @@ int FirstNumBest::AddNewTrackState(const int64_t &track_id,
   state->start_ = frame_id;
   state->count_ = 0;
   state->finish_ = false;
-  select_states_[track_id] = state;
+  select_states_.Insert(track_id, state);
   return XROC_SNAPSHOT_OK;
 }
 
@@ -449,14 +529,13 @@ bool FirstNumBest::ReadyToPost(StatePtr &trackstate) {
 }
 
 void FirstNumBest::Finalize() {
-  auto iter = select_states_.begin();
-  while (iter != select_states_.end()) {
-    iter = select_states_.erase(iter);
-  }
+  select_states_.clear();
 }
 
 int FirstNumBest::UpdateParameter(const std::string &content) {
-  return snapshot_config_param_->UpdateParameter(content);
+  int ret = snapshot_config_param_->UpdateParameter(content);
+  select_states_.Reserve(GetConfig()->max_tracks);
+  return ret;
 }
 
 std::shared_ptr<FirstNumBestParam> FirstNumBest::GetConfig() {
@@ -490,6 +569,10 @@ int FirstNumBestParam::UpdateParameter(const std::string &content) {
     SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, max_crop_num_per_frame);
     SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, smoothing_frame_range);
     SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, avg_crop_num_per_frame);
+    SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, max_retained_frames);
+    SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, origin_frame_budget_kb);
+    SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, origin_frames_per_channel);
+    SET_SNAPSHOT_METHOD_PARAM(json_var, UInt, origin_frame_downscale);
     SET_SNAPSHOT_METHOD_PARAM(json_var, UInt64, begin_post_frame_thr);
     SET_SNAPSHOT_METHOD_PARAM(json_var, UInt64, resnap_value);
     SET_SNAPSHOT_METHOD_PARAM(json_var, Bool, report_flushed_track_flag);
@@ -502,6 +585,10 @@ int FirstNumBestParam::UpdateParameter(const std::string &content) {
     LOGD << "max_crop_num_per_frame: " << max_crop_num_per_frame;
     LOGD << "smoothing_frame_range: " << smoothing_frame_range;
     LOGD << "avg_crop_num_per_frame: " << avg_crop_num_per_frame;
+    LOGD << "max_retained_frames: " << max_retained_frames;
+    LOGD << "origin_frame_budget_kb: " << origin_frame_budget_kb;
+    LOGD << "origin_frames_per_channel: " << origin_frames_per_channel;
+    LOGD << "origin_frame_downscale: " << origin_frame_downscale;
     LOGD << "begin_post_frame_thr: " << begin_post_frame_thr;
     LOGD << "resnap_value: " << resnap_value;
     LOGD << "report_flushed_track_flag: " << report_flushed_track_flag;
@@ -13,14 +13,21 @@
 #include <cassert>
 #include <fstream>
 #include <sstream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "hobotxsdk/xroc_sdk.h"
 #include "test_support.hpp"
 #include "hobotlog/hobotlog.hpp"
 #include "SnapShotMethod/strategy/first_num_best.h"
+#include "SnapShotMethod/strategy/track_state_table.h"
 #include "SnapShotMethod/snapshot_data_type/snapshot_data_type.hpp"
+#include "SnapShotMethod/image_utils/frame_retention.hpp"
+#include "SnapShotMethod/image_utils/image_utils.hpp"
+#include "SnapShotMethod/image_utils/snapshot_buffer_pool.hpp"
 
 class XRocSelectMethodTest : public ::testing::Test {
  public:
@@ -1142,6 +1149,172 @@ TEST_F(XRocSelectMethodTest, EmptyUserdata) {
   delete flow;
 }
 
+TEST(SnapshotImageUtilsTest, CropResizeNV12) {
+  // 8x6 nv12, y = index, uv = 200
+  std::vector<uint8_t> y_data(8 * 6), uv_data(8 * 3, 200);
+  for (size_t i = 0; i < y_data.size(); i++) {
+    y_data[i] = i;
+  }
+  // crop outside the top left corner is padded with black
+  std::vector<uint8_t> snap(4 * 4 * 3 / 2);
+  HobotXRoc::ImageUtils::CropResizeNV12(y_data.data(), 8, uv_data.data(), 8,
+                                        8, 6, -2, -2, 4, 4, 4, 4,
+                                        snap.data());
+  std::vector<uint8_t> gt_y = {16, 16, 16, 16,
+                               16, 16, 16, 16,
+                               16, 16, 0, 1,
+                               16, 16, 8, 9};
+  std::vector<uint8_t> gt_uv = {128, 128, 128, 128, 128, 128, 200, 200};
+  EXPECT_EQ(gt_y, std::vector<uint8_t>(snap.begin(), snap.begin() + 16));
+  EXPECT_EQ(gt_uv, std::vector<uint8_t>(snap.begin() + 16, snap.end()));
+  // 2x down scale averages 2x2 blocks
+  snap.resize(2 * 2 * 3 / 2);
+  HobotXRoc::ImageUtils::CropResizeNV12(y_data.data(), 8, uv_data.data(), 8,
+                                        8, 6, 0, 0, 4, 4, 2, 2,
+                                        snap.data());
+  std::vector<uint8_t> gt_scale = {5, 7, 21, 23, 200, 200};
+  EXPECT_EQ(gt_scale, snap);
+}
+
+TEST(SnapshotImageUtilsTest, SnapshotBufferPool) {
+  HobotXRoc::SnapshotBufferPool pool(1);
+  uint8_t *first = nullptr;
+  {
+    auto buf1 = pool.Acquire(64, 64);
+    auto buf2 = pool.Acquire(64, 64);
+    first = buf1.get();
+    EXPECT_NE(first, buf2.get());
+  }
+  // only one buffer is kept per resolution
+  EXPECT_EQ(1u, pool.FreeCount(64, 64));
+  EXPECT_EQ(0u, pool.FreeCount(128, 128));
+  auto buf = pool.Acquire(64, 64);
+  EXPECT_EQ(0u, pool.FreeCount(64, 64));
+  auto other = pool.Acquire(128, 128);
+  EXPECT_NE(buf.get(), other.get());
+}
+
+TEST(SnapshotImageUtilsTest, SnapshotBufferPoolMat) {
+  HobotXRoc::SnapshotBufferPool pool(1);
+  cv::Mat copy;
+  {
+    auto buf = pool.Acquire(64, 64);
+    auto mat = HobotXRoc::SnapshotBufferPool::WrapMat(buf, 96, 64, CV_8UC1);
+    EXPECT_EQ(buf.get(), mat.data);
+    copy = mat;
+  }
+  // the copy of the Mat still holds the buffer
+  EXPECT_EQ(0u, pool.FreeCount(64, 64));
+  copy.release();
+  EXPECT_EQ(1u, pool.FreeCount(64, 64));
+}
+
+TEST(SnapshotTrackStateTableTest, InsertFindErase) {
+  HobotXRoc::TrackStateTable<int> table(4);
+  std::map<int32_t, int> gt;
+  // ids colliding in a 16 slot table
+  for (int32_t id = 0; id < 64; id += 16) {
+    table.Insert(id, id + 1);
+    gt[id] = id + 1;
+  }
+  for (int32_t id = 1; id < 200; id += 3) {
+    table.Insert(id, id + 1);
+    gt[id] = id + 1;
+  }
+  EXPECT_EQ(gt.size(), table.size());
+  table.EraseIf([](int32_t id, int &value) { return id % 2 == 0; });
+  for (auto iter = gt.begin(); iter != gt.end();) {
+    iter = iter->first % 2 == 0 ? gt.erase(iter) : std::next(iter);
+  }
+  EXPECT_FALSE(table.Erase(1000));
+  EXPECT_EQ(gt.size(), table.size());
+  for (int32_t id = -10; id < 250; id++) {
+    auto *value = table.Find(id);
+    if (gt.count(id)) {
+      ASSERT_TRUE(value != nullptr);
+      EXPECT_EQ(gt[id], *value);
+    } else {
+      EXPECT_TRUE(value == nullptr);
+    }
+  }
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_TRUE(table.Find(1) == nullptr);
+}
+
+static HobotXRoc::SelectSnapShotInfoPtr MakeOriginSnap(
+    uint64_t frame_id, uint32_t channel_id) {
+  std::shared_ptr<hobot::vision::CVImageFrame> frame(
+      new hobot::vision::CVImageFrame());
+  frame->img = cv::Mat(16 * 3 / 2, 16, CV_8UC1, cv::Scalar(100));
+  frame->pixel_format = kHorizonVisionPixelFormatRawNV12;
+  frame->frame_id = frame_id;
+  frame->time_stamp = frame_id;
+  frame->channel_id = channel_id;
+  HobotXRoc::SelectSnapShotInfoPtr snap(new HobotXRoc::SelectSnapShotInfo());
+  snap->origin_image_frame = frame;
+  return snap;
+}
+
+TEST(SnapshotImageUtilsTest, FrameRetention) {
+  std::vector<HobotXRoc::SelectSnapShotInfoPtr> snaps = {
+      MakeOriginSnap(1, 0), MakeOriginSnap(2, 0), MakeOriginSnap(3, 0),
+      MakeOriginSnap(1, 1)};
+  HobotXRoc::FrameRetention retention;
+  // at most 2 frames per channel, the oldest frame of channel 0 is
+  // replaced by a 2x downscaled copy
+  retention.Limit(snaps, 0, 2, 2);
+  EXPECT_EQ(3u, retention.PinnedFrames());
+  EXPECT_EQ(3u * 16 * 24, retention.PinnedBytes());
+  auto downscaled = std::dynamic_pointer_cast<HobotXRoc::DownscaledImageFrame>(
+      snaps[0]->origin_image_frame);
+  ASSERT_TRUE(downscaled != nullptr);
+  EXPECT_EQ(8u, downscaled->Width());
+  EXPECT_EQ(8u, downscaled->Height());
+  EXPECT_EQ(1u, downscaled->frame_id);
+  EXPECT_EQ(100, downscaled->Data()[0]);
+  // budget of one frame, the older frames lose their image data
+  retention.Limit(snaps, 16 * 24, 0, 0);
+  EXPECT_EQ(1u, retention.PinnedFrames());
+  EXPECT_TRUE(snaps[1]->origin_image_frame->Data() == nullptr);
+  EXPECT_TRUE(snaps[3]->origin_image_frame->Data() == nullptr);
+  EXPECT_TRUE(snaps[2]->origin_image_frame->Data() != nullptr);
+  EXPECT_EQ(1u, snaps[3]->origin_image_frame->channel_id);
+}
+
+TEST(SnapshotImageUtilsTest, FrameRetentionPendingCrop) {
+  // a lazy crop candidate holds frame 1, frame 2 is an origin frame
+  auto pending = MakeOriginSnap(1, 0);
+  pending->crop_frame = pending->origin_image_frame;
+  pending->origin_image_frame = nullptr;
+  pending->crop_rect = hobot::vision::BBox(0, 0, 8, 8);
+  pending->output_width = 8;
+  pending->output_height = 8;
+  std::vector<HobotXRoc::SelectSnapShotInfoPtr> snaps = {
+      pending, MakeOriginSnap(2, 0)};
+  HobotXRoc::FrameRetention retention;
+  retention.Limit(snaps, 0, 2, 2);
+  EXPECT_EQ(2u, retention.PinnedFrames());
+  EXPECT_TRUE(pending->HasPendingCrop());
+
+  // one frame per channel, the pending crop of frame 1 is handed back
+  std::vector<HobotXRoc::SelectSnapShotInfoPtr> crops;
+  retention.Limit(snaps, 0, 1, 2, &crops);
+  EXPECT_EQ(1u, retention.PinnedFrames());
+  EXPECT_EQ(16u * 24, retention.PinnedBytes());
+  ASSERT_EQ(1u, crops.size());
+  EXPECT_EQ(pending, crops[0]);
+  EXPECT_TRUE(pending->HasPendingCrop());
+
+  // without crops it is done by Limit
+  retention.Limit(snaps, 0, 1, 2);
+  EXPECT_EQ(1u, retention.PinnedFrames());
+  EXPECT_FALSE(pending->HasPendingCrop());
+  EXPECT_TRUE(pending->snap != nullptr);
+  retention.Limit(snaps, 0, 1, 2);
+  EXPECT_EQ(1u, retention.PinnedFrames());
+}
+
 int main(int argc, char* argv[]) {
   SetLogLevel(HOBOT_LOG_ERROR);
   ::testing::InitGoogleTest(&argc, argv);
@@ -23,6 +23,7 @@ namespace HobotXRoc {
 class PostPredictor;
 class Predictor;
 class CNNMethodConfig;
+class AttributeCache;
 
 class CNNMethod : public Method {
  public:
@@ -43,6 +44,8 @@ class CNNMethod : public Method {
  private:
   std::shared_ptr<Predictor> predictor_;
   std::shared_ptr<PostPredictor> post_predict_;
+  // only for rect/img input with enable_attr_cache set, else nullptr
+  std::shared_ptr<AttributeCache> attr_cache_;
 
   std::shared_ptr<CNNMethodConfig> config_;
   static std::mutex init_mutex_;
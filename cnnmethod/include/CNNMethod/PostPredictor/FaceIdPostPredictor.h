@@ -12,6 +12,8 @@
 #ifndef INCLUDE_CNNMETHOD_POSTPREDICTOR_FACEIDPOSTPREDICTOR_H_
 #define INCLUDE_CNNMETHOD_POSTPREDICTOR_FACEIDPOSTPREDICTOR_H_
 
+#include <memory>
+#include <string>
 #include <vector>
 #include "CNNMethod/PostPredictor/PostPredictor.h"
 
@@ -19,11 +21,18 @@ namespace HobotXRoc {
 
 class FaceIdPostPredictor : public PostPredictor {
  public:
+  virtual int32_t Init(std::shared_ptr<CNNMethodConfig> config);
   virtual void Do(CNNMethodRunData *run_data);
+  virtual void UpdateParam(std::shared_ptr<CNNMethodConfig> config);
 
  private:
+  enum class FeatureFormat { FLOAT, INT8, FP16 };
+
   BaseDataPtr
     FaceFeaturePostPro(const std::vector<std::vector<int8_t>> &mxnet_outs);
+  void SetFeatureFormat(const std::string &format);
+
+  FeatureFormat feature_format_ = FeatureFormat::FLOAT;
 };
 }  // namespace HobotXRoc
 #endif  // INCLUDE_CNNMETHOD_POSTPREDICTOR_FACEIDPOSTPREDICTOR_H_
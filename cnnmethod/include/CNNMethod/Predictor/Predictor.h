@@ -27,29 +27,29 @@
 #include "horizon/vision_type/vision_type.hpp"
 #include "horizon/vision_type/vision_type_common.h"
 #include "hobot_vision/bpu_handle_manager.hpp"
+#include "hobot_vision/bpumodel_manager.hpp"
 
 namespace HobotXRoc {
 
+// output buffers checked out from the model's pool, given back on destroy
 class ModelOutputBuffer {
  public:
   ModelOutputBuffer() = delete;
-  ModelOutputBuffer(const ModelInfo &model_info, int target_num) {
-    for (int i = 0; i < target_num; ++i) {
-      for (auto n : model_info.output_layer_size_) {
-        BPU_Buffer_Handle out_handle = BPU_createEmptyBPUBuffer();
-        out_bufs_.push_back(out_handle);
-      }
-    }
+  ModelOutputBuffer(
+      const std::shared_ptr<hobot::vision::BPUOutputBufferPool> &pool,
+      int target_num)
+      : pool_(pool) {
+    pool_->Get(target_num, &out_bufs_);
   }
   ~ModelOutputBuffer() {
-    for (auto &out_buf : out_bufs_) {
-      BPU_freeBPUBuffer(out_buf);
-    }
-    out_bufs_.clear();
+    pool_->Put(&out_bufs_);
   }
 
  public:
   std::vector<BPU_Buffer_Handle> out_bufs_;
+
+ private:
+  std::shared_ptr<hobot::vision::BPUOutputBufferPool> pool_;
 };
 
 class Predictor {
@@ -76,6 +76,15 @@ class Predictor {
                           int output_size);
   // void RunModelFromDDR();
 
+  // whether the result of the object is served by AttributeCache
+  bool IsCacheHit(const CNNMethodRunData *run_data,
+                  size_t frame_idx,
+                  size_t roi_idx) const {
+    return frame_idx < run_data->cached_output.size()
+           && roi_idx < run_data->cached_output[frame_idx].size()
+           && !run_data->cached_output[frame_idx][roi_idx].empty();
+  }
+
   void ConvertOutputToMXNet(void *src_ptr, void *dest_ptr, int layer_idx);
 
   int NormalizeRoi(hobot::vision::BBox *src,
@@ -94,6 +103,7 @@ class Predictor {
   BPUFakeImageHandle fake_img_handle_ = nullptr;
 
   ModelInfo model_info_;
+  std::shared_ptr<hobot::vision::BPUOutputBufferPool> out_buf_pool_;
   std::string model_path_;
   std::vector<std::vector<int8_t>> feature_bufs_;
   int32_t max_handle_num_ = -1;  // Less than 0 means unlimited
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @File: AttributeCache.h
+ * @Brief: declaration of the AttributeCache
+ * @Author: agent
+ * @Email: agent@local
+ * @Date: 2026-10-19
+ * @Last Modified by: agent
+ * @Last Modified time: 2026-10-19
+ */
+
+#ifndef INCLUDE_CNNMETHOD_UTIL_ATTRIBUTECACHE_H_
+#define INCLUDE_CNNMETHOD_UTIL_ATTRIBUTECACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "CNNMethod/util/CNNMethodConfig.h"
+#include "CNNMethod/util/CNNMethodData.h"
+#include "horizon/vision_type/vision_type.hpp"
+
+namespace HobotXRoc {
+
+/**
+ * Per-track cache of post-processed attribute results (age/gender,
+ * anti-spoofing, quality...). A cached result is reused while the track's
+ * box stays close to the box it was computed on; cache hits are skipped by
+ * the predictor so they never reach the BPU. Each hit gets its own copy of
+ * the cached XRocData, the cache never shares its objects with a frame.
+ */
+class AttributeCache {
+ public:
+  AttributeCache() {}
+
+  void Init(std::shared_ptr<CNNMethodConfig> config);
+  void UpdateParam(std::shared_ptr<CNNMethodConfig> config);
+
+  // fill run_data->cached_output, must be called before Predictor::Do
+  void Lookup(CNNMethodRunData *run_data);
+  // merge cached results into run_data->output and store the new ones,
+  // must be called after PostPredictor::Do
+  void Update(CNNMethodRunData *run_data);
+
+ private:
+  struct Entry {
+    hobot::vision::BBox box;        // box the result was computed on
+    int hit_cnt = 0;                // frames served since computed
+    uint64_t last_seen = 0;         // frame sequence of channel
+    std::vector<BaseDataPtr> output;  // one element per output slot
+  };
+
+  static uint64_t MakeKey(uint32_t channel_id, int32_t track_id) {
+    return (static_cast<uint64_t>(channel_id) << 32)
+           | static_cast<uint32_t>(track_id);
+  }
+  bool IsReusable(const Entry &entry, const hobot::vision::BBox &box) const;
+  // drop tracks of the channel which are not seen for more than max_age_
+  // frames
+  void Evict(uint32_t channel_id, uint64_t frame_seq);
+
+  float iou_thresh_ = 0.8f;
+  float size_change_ratio_ = 0.2f;
+  int max_age_ = 10;
+
+  std::unordered_map<uint64_t, Entry> entries_;
+  std::unordered_map<uint32_t, uint64_t> frame_seq_;  // per channel
+  std::mutex mutex_;
+};
+
+}  // namespace HobotXRoc
+#endif  // INCLUDE_CNNMETHOD_UTIL_ATTRIBUTECACHE_H_
@@ -35,6 +35,11 @@ struct CNNMethodRunData {
   // mxnet_output_[i][j][k]: frame i, object j, layer k
   std::vector<std::vector<std::vector<std::vector<int8_t>>>> mxnet_output;
 
+  // filled by AttributeCache, empty if the cache is disabled
+  // cached_output[i][j] : frame i, object j, one result per output slot,
+  //                       empty if object j is not a cache hit
+  std::vector<std::vector<std::vector<BaseDataPtr>>> cached_output;
+
   std::vector<std::vector<BaseDataPtr>> output;
 };
 }  // namespace HobotXRoc
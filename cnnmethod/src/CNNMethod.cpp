@@ -21,6 +21,7 @@
 #include "CNNMethod/PostPredictor/PostPredictor.h"
 #include "CNNMethod/Predictor/Predictor.h"
 #include "CNNMethod/Predictor/PredictorFactory.h"
+#include "CNNMethod/util/AttributeCache.h"
 #include "CNNMethod/util/CNNMethodConfig.h"
 #include "CNNMethod/util/CNNMethodData.h"
 #include "CNNMethod/util/util.h"
@@ -51,6 +52,14 @@ int32_t CNNMethod::Init(const std::string &cfg_path) {
   HOBOT_CHECK(fn_iter != g_post_fun_map.end()) << "post_fn unknown:" << post_fn;
   post_predict_.reset(PostPredictorFactory::GetPostPredictor(fn_iter->second));
 
+  if (config_->GetBoolValue("enable_attr_cache")) {
+    HOBOT_CHECK(iter->second == InputType::RECT
+                || iter->second == InputType::IMG)
+        << "attribute cache only support rect/img input";
+    attr_cache_ = std::make_shared<AttributeCache>();
+    attr_cache_->Init(config_);
+  }
+
   std::unique_lock<std::mutex> lock(init_mutex_);
   predictor_->Init(config_);
   post_predict_->Init(config_);
@@ -67,8 +76,14 @@ CNNMethod::DoProcess(const std::vector<std::vector<BaseDataPtr>> &input,
   run_data.input = &input;
   run_data.param = &param;
 
+  if (attr_cache_) {
+    attr_cache_->Lookup(&run_data);
+  }
   predictor_->Do(&run_data);
   post_predict_->Do(&run_data);
+  if (attr_cache_) {
+    attr_cache_->Update(&run_data);
+  }
   return run_data.output;
 }
 
@@ -79,6 +94,9 @@ int CNNMethod::UpdateParameter(HobotXRoc::InputParamPtr ptr) {
     UpdateParams(cf.config, config_->config);
     predictor_->UpdateParam(config_);
     post_predict_->UpdateParam(config_);
+    if (attr_cache_) {
+      attr_cache_->UpdateParam(config_);
+    }
     return 0;
   } else {
     HOBOT_CHECK(0) << "only support json format config";
@@ -10,14 +10,42 @@
  */
 
 #include "CNNMethod/PostPredictor/FaceIdPostPredictor.h"
+#include <string>
 #include <vector>
 #include "CNNMethod/CNNConst.h"
 #include "CNNMethod/util/util.h"
 #include "hobotlog/hobotlog.hpp"
 #include "hobotxroc/profiler.h"
+#include "hobotxsdk/compact_feature.h"
 
 namespace HobotXRoc {
 
+int32_t FaceIdPostPredictor::Init(std::shared_ptr<CNNMethodConfig> config) {
+  PostPredictor::Init(config);
+  SetFeatureFormat(config->GetSTDStringValue("feature_format", "float"));
+  return 0;
+}
+
+void FaceIdPostPredictor::UpdateParam(
+    std::shared_ptr<CNNMethodConfig> config) {
+  PostPredictor::UpdateParam(config);
+  if (config->KeyExist("feature_format")) {
+    SetFeatureFormat(config->GetSTDStringValue("feature_format"));
+  }
+}
+
+void FaceIdPostPredictor::SetFeatureFormat(const std::string &format) {
+  if (format == "float") {
+    feature_format_ = FeatureFormat::FLOAT;
+  } else if (format == "int8") {
+    feature_format_ = FeatureFormat::INT8;
+  } else if (format == "fp16") {
+    feature_format_ = FeatureFormat::FP16;
+  } else {
+    LOGE << "feature_format is unknown:" << format;
+  }
+}
+
 void FaceIdPostPredictor::Do(CNNMethodRunData *run_data) {
   int batch_size = run_data->input_dim_size.size();
   run_data->output.resize(batch_size);
@@ -43,6 +71,8 @@ void FaceIdPostPredictor::Do(CNNMethodRunData *run_data) {
       auto one_person_snaps =
           dynamic_cast<BaseDataVector *>(snaps->datas_[person_idx].get());
       if (!one_person_snaps) {
+        // keep feature_list aligned with the persons of snap_list
+        data_vector->datas_.push_back(face_features);
         continue;
       }
       for (uint32_t snap_idx = 0; snap_idx < one_person_snaps->datas_.size()
@@ -67,13 +97,22 @@ BaseDataPtr FaceIdPostPredictor::FaceFeaturePostPro(
   static const int kFeatureCnt = 128;
   auto mxnet_rlt = reinterpret_cast<const float *>(mxnet_outs[0].data());
 
-  auto feature = std::make_shared<XRocData<hobot::vision::Feature>>();
-  feature->value.values.resize(kFeatureCnt);
-  for (int i = 0; i < kFeatureCnt; i++) {
-    feature->value.values[i] = mxnet_rlt[i];
+  // one pass for the norm (and the range for int8), one pass to write the
+  // normalized result in the output format
+  if (feature_format_ == FeatureFormat::FLOAT) {
+    auto feature = std::make_shared<XRocData<hobot::vision::Feature>>();
+    feature->value.values.resize(kFeatureCnt);
+    CompactFeature::Normalize(mxnet_rlt, kFeatureCnt,
+                              feature->value.values.data());
+    return std::static_pointer_cast<BaseData>(feature);
   }
 
-  l2_norm(feature->value.values, kFeatureCnt);
+  auto feature = std::make_shared<XRocData<CompactFeature>>();
+  feature->type_ = COMPACT_FEATURE_TYPE;
+  feature->value.Encode(mxnet_rlt, kFeatureCnt,
+                        feature_format_ == FeatureFormat::INT8
+                            ? CompactFeature::Format::INT8
+                            : CompactFeature::Format::FP16);
   return std::static_pointer_cast<BaseData>(feature);
 }
 
@@ -110,7 +110,8 @@ void ImgInputPredictor::Do(CNNMethodRunData *run_data) {
           std::static_pointer_cast<XRocData<BBox>>(rois->datas_[roi_idx]);
       auto p_norm_roi = std::make_shared<XRocData<BBox>>();
       norm_rois[roi_idx] = std::static_pointer_cast<BaseData>(p_norm_roi);
-      if (p_roi->state_ != HobotXRoc::DataState::VALID) {
+      if (p_roi->state_ != HobotXRoc::DataState::VALID
+          || IsCacheHit(run_data, frame_idx, roi_idx)) {
         p_norm_roi->value = p_roi->value;
         continue;
       }
@@ -247,7 +248,7 @@ void ImgInputPredictor::Do(CNNMethodRunData *run_data) {
           src_2_stride = dst_2_stride;
         }
       }
-      ModelOutputBuffer bufs(model_info_, 1);
+      ModelOutputBuffer bufs(out_buf_pool_, 1);
       {
 #if 0
         static int data_idx = 0;
@@ -100,7 +100,7 @@ void LmkInputPredictor::Do(CNNMethodRunData *run_data) {
           LOGD << "lmk x:" << point.x << ", y:" << point.y;
         }
 
-        ModelOutputBuffer bufs(model_info_, 1);
+        ModelOutputBuffer bufs(out_buf_pool_, 1);
         {
           RUN_PROCESS_TIME_PROFILER(model_name_ + "_do_cnn")
           RUN_FPS_PROFILER(model_name_ + "_do_cnn")
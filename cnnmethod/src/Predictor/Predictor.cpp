@@ -60,6 +60,9 @@ int32_t Predictor::Init(std::shared_ptr<CNNMethodConfig> config) {
   model_info_.Init(bpu_handle_, model_name_, &input_model_info,
                     &output_model_info);
 
+  out_buf_pool_ = hobot::vision::BPUModelManager::Get().GetOutputBufferPool(
+      model_path_, model_name_, model_info_.output_layer_size_.size());
+
   feature_bufs_.resize(model_info_.output_layer_size_.size());
   for (int i = 0; i < model_info_.output_layer_size_.size(); i++) {
     feature_bufs_[i].resize(model_info_.output_layer_size_[i]);
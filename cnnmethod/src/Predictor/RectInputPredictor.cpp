@@ -59,7 +59,8 @@ void RectInputPredictor::Do(CNNMethodRunData *run_data) {
       norm_rois[roi_idx] = std::static_pointer_cast<BaseData>(p_norm_roi);
       p_norm_roi->value = p_roi->value;
       if (p_roi->state_ != HobotXRoc::DataState::VALID
-          || roi_idx >= handle_num) {
+          || roi_idx >= handle_num
+          || IsCacheHit(run_data, frame_idx, roi_idx)) {
         valid_box[roi_idx] = 0;
       } else {
         boxes.push_back(BPUBBox{p_roi->value.x1,
@@ -73,7 +74,10 @@ void RectInputPredictor::Do(CNNMethodRunData *run_data) {
              << p_roi->value.x2 << "," << p_roi->value.y2 << "}";
       }
     }
-    ModelOutputBuffer bufs(model_info_, boxes.size());
+    if (boxes.empty()) {
+      continue;
+    }
+    ModelOutputBuffer bufs(out_buf_pool_, boxes.size());
     {
       RUN_PROCESS_TIME_PROFILER(model_name_ + "_runmodel")
       RUN_FPS_PROFILER(model_name_ + "_runmodel")
@@ -0,0 +1,223 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @File: AttributeCache.cpp
+ * @Brief: definition of the AttributeCache
+ * @Author: agent
+ * @Email: agent@local
+ * @Date: 2026-10-19
+ * @Last Modified by: agent
+ * @Last Modified time: 2026-10-19
+ */
+
+#include "CNNMethod/util/AttributeCache.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "hobotlog/hobotlog.hpp"
+#include "hobotxsdk/compact_feature.h"
+
+using hobot::vision::BBox;
+using hobot::vision::ImageFrame;
+typedef std::shared_ptr<ImageFrame> ImageFramePtr;
+
+namespace HobotXRoc {
+
+static float BoxIoU(const BBox &a, const BBox &b) {
+  float xx1 = std::max(a.x1, b.x1);
+  float yy1 = std::max(a.y1, b.y1);
+  float xx2 = std::min(a.x2, b.x2);
+  float yy2 = std::min(a.y2, b.y2);
+  if (xx2 <= xx1 || yy2 <= yy1) {
+    return 0.0f;
+  }
+  float inter = (xx2 - xx1) * (yy2 - yy1);
+  float uni = a.Width() * a.Height() + b.Width() * b.Height() - inter;
+  return uni > 0 ? inter / uni : 0.0f;
+}
+
+template <typename T>
+static bool CopyAs(const BaseDataPtr &src, BaseDataPtr *dst) {
+  auto data = std::dynamic_pointer_cast<XRocData<T>>(src);
+  if (!data) {
+    return false;
+  }
+  *dst = std::make_shared<XRocData<T>>(*data);
+  return true;
+}
+
+// copy of the XRocData object, its value is copied, nullptr for a type the
+// attribute post predictors do not output
+static BaseDataPtr ShallowCopy(const BaseDataPtr &src) {
+  BaseDataPtr dst;
+  CopyAs<hobot::vision::Age>(src, &dst)
+      || CopyAs<hobot::vision::Attribute<int32_t>>(src, &dst)
+      || CopyAs<hobot::vision::Landmarks>(src, &dst)
+      || CopyAs<hobot::vision::Pose3D>(src, &dst)
+      || CopyAs<hobot::vision::Feature>(src, &dst)
+      || CopyAs<CompactFeature>(src, &dst);
+  return dst;
+}
+
+static uint32_t GetChannelId(const std::vector<BaseDataPtr> &input_data) {
+  if (input_data.size() < 2 || !input_data[1]) {
+    return 0;
+  }
+  auto xroc_img =
+      std::static_pointer_cast<XRocData<ImageFramePtr>>(input_data[1]);
+  return xroc_img->value ? xroc_img->value->channel_id : 0;
+}
+
+void AttributeCache::Init(std::shared_ptr<CNNMethodConfig> config) {
+  iou_thresh_ = config->GetFloatValue("attr_cache_iou_thresh", iou_thresh_);
+  size_change_ratio_ =
+      config->GetFloatValue("attr_cache_size_change_ratio", size_change_ratio_);
+  max_age_ = config->GetIntValue("attr_cache_max_age", max_age_);
+  LOGI << "attribute cache enabled, iou_thresh:" << iou_thresh_
+       << ", size_change_ratio:" << size_change_ratio_
+       << ", max_age:" << max_age_;
+}
+
+void AttributeCache::UpdateParam(std::shared_ptr<CNNMethodConfig> config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (config->KeyExist("attr_cache_iou_thresh")) {
+    iou_thresh_ = config->GetFloatValue("attr_cache_iou_thresh");
+  }
+  if (config->KeyExist("attr_cache_size_change_ratio")) {
+    size_change_ratio_ = config->GetFloatValue("attr_cache_size_change_ratio");
+  }
+  if (config->KeyExist("attr_cache_max_age")) {
+    max_age_ = config->GetIntValue("attr_cache_max_age");
+  }
+}
+
+bool AttributeCache::IsReusable(const Entry &entry, const BBox &box) const {
+  if (entry.hit_cnt >= max_age_) {
+    return false;
+  }
+  float old_w = entry.box.Width();
+  float old_h = entry.box.Height();
+  if (old_w <= 0 || old_h <= 0) {
+    return false;
+  }
+  if (std::fabs(box.Width() / old_w - 1.0f) > size_change_ratio_
+      || std::fabs(box.Height() / old_h - 1.0f) > size_change_ratio_) {
+    return false;
+  }
+  return BoxIoU(entry.box, box) >= iou_thresh_;
+}
+
+void AttributeCache::Evict(uint32_t channel_id, uint64_t frame_seq) {
+  // a track missed by the detector for a few frames keeps its entry
+  uint64_t max_age = static_cast<uint64_t>(std::max(max_age_, 0));
+  for (auto iter = entries_.begin(); iter != entries_.end();) {
+    if ((iter->first >> 32) == channel_id
+        && iter->second.last_seen + max_age < frame_seq) {
+      iter = entries_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void AttributeCache::Lookup(CNNMethodRunData *run_data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t frame_size = run_data->input->size();
+  run_data->cached_output.resize(frame_size);
+  for (size_t frame_idx = 0; frame_idx < frame_size; frame_idx++) {
+    auto &input_data = (*(run_data->input))[frame_idx];
+    auto rois = std::static_pointer_cast<BaseDataVector>(input_data[0]);
+    uint32_t channel_id = GetChannelId(input_data);
+    uint64_t frame_seq = ++frame_seq_[channel_id];
+
+    size_t box_num = rois->datas_.size();
+    auto &cached = run_data->cached_output[frame_idx];
+    cached.clear();
+    cached.resize(box_num);
+    int hit_num = 0;
+    for (size_t roi_idx = 0; roi_idx < box_num; roi_idx++) {
+      auto p_roi =
+          std::static_pointer_cast<XRocData<BBox>>(rois->datas_[roi_idx]);
+      if (p_roi->state_ != DataState::VALID || p_roi->value.id < 0) {
+        continue;
+      }
+      auto iter = entries_.find(MakeKey(channel_id, p_roi->value.id));
+      if (iter == entries_.end()) {
+        continue;
+      }
+      auto &entry = iter->second;
+      entry.last_seen = frame_seq;
+      if (IsReusable(entry, p_roi->value)) {
+        // the outputs of each frame are owned by its consumers
+        entry.hit_cnt++;
+        auto &result = cached[roi_idx];
+        for (const auto &data : entry.output) {
+          result.push_back(ShallowCopy(data));
+        }
+        hit_num++;
+      }
+    }
+    Evict(channel_id, frame_seq);
+    LOGD << "attribute cache hit " << hit_num << "/" << box_num;
+  }
+}
+
+void AttributeCache::Update(CNNMethodRunData *run_data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t frame_size = std::min(run_data->cached_output.size(),
+                               run_data->output.size());
+  for (size_t frame_idx = 0; frame_idx < frame_size; frame_idx++) {
+    auto &input_data = (*(run_data->input))[frame_idx];
+    auto rois = std::static_pointer_cast<BaseDataVector>(input_data[0]);
+    uint32_t channel_id = GetChannelId(input_data);
+    uint64_t frame_seq = frame_seq_[channel_id];
+
+    auto &cached = run_data->cached_output[frame_idx];
+    auto &frame_output = run_data->output[frame_idx];
+    size_t slot_size = frame_output.size();
+    for (size_t roi_idx = 0; roi_idx < cached.size(); roi_idx++) {
+      if (!cached[roi_idx].empty()) {
+        // hit: replace the placeholders of the skipped box
+        for (size_t slot_idx = 0; slot_idx < slot_size; slot_idx++) {
+          auto slot =
+              std::static_pointer_cast<BaseDataVector>(frame_output[slot_idx]);
+          if (roi_idx < slot->datas_.size()
+              && slot_idx < cached[roi_idx].size()) {
+            slot->datas_[roi_idx] = cached[roi_idx][slot_idx];
+          }
+        }
+        continue;
+      }
+      auto p_roi =
+          std::static_pointer_cast<XRocData<BBox>>(rois->datas_[roi_idx]);
+      if (p_roi->state_ != DataState::VALID || p_roi->value.id < 0) {
+        continue;
+      }
+      // miss: keep a copy of the freshly predicted result if every slot is
+      // valid
+      std::vector<BaseDataPtr> result(slot_size);
+      bool valid = slot_size > 0;
+      for (size_t slot_idx = 0; valid && slot_idx < slot_size; slot_idx++) {
+        auto slot =
+            std::static_pointer_cast<BaseDataVector>(frame_output[slot_idx]);
+        if (roi_idx >= slot->datas_.size() || !slot->datas_[roi_idx]
+            || slot->datas_[roi_idx]->state_ != DataState::VALID) {
+          valid = false;
+        } else {
+          result[slot_idx] = ShallowCopy(slot->datas_[roi_idx]);
+          valid = result[slot_idx] != nullptr;
+        }
+      }
+      if (!valid) {
+        continue;
+      }
+      auto &entry = entries_[MakeKey(channel_id, p_roi->value.id)];
+      entry.box = p_roi->value;
+      entry.hit_cnt = 0;
+      entry.last_seen = frame_seq;
+      entry.output = std::move(result);
+    }
+  }
+}
+
+}  // namespace HobotXRoc
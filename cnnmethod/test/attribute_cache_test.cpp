@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @file attribute_cache_test.cpp
+ * @brief hit/miss, box change, max age and eviction of the AttributeCache
+ * @author agent
+ * @email agent@local
+ * @date 2026/10/19
+ */
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "CNNMethod/util/AttributeCache.h"
+
+using HobotXRoc::AttributeCache;
+using HobotXRoc::BaseDataPtr;
+using HobotXRoc::BaseDataVector;
+using HobotXRoc::CNNMethodConfig;
+using HobotXRoc::CNNMethodRunData;
+using HobotXRoc::DataState;
+using HobotXRoc::XRocData;
+using hobot::vision::Age;
+using hobot::vision::BBox;
+
+namespace {
+typedef std::vector<std::vector<BaseDataPtr>> FrameData;
+
+class AttributeCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto config = std::make_shared<CNNMethodConfig>(
+        "{\"attr_cache_iou_thresh\": 0.8,"
+        " \"attr_cache_size_change_ratio\": 0.2,"
+        " \"attr_cache_max_age\": 3}");
+    cache_.Init(config);
+  }
+
+  // one frame of channel 0 with the boxes, returns the age slot of the
+  // output. A miss is predicted as value, a hit is a placeholder replaced
+  // by the cache
+  std::shared_ptr<BaseDataVector> Run(const std::vector<BBox> &boxes,
+                                      int value) {
+    auto rois = std::make_shared<BaseDataVector>();
+    for (auto &box : boxes) {
+      rois->datas_.push_back(std::make_shared<XRocData<BBox>>(box));
+    }
+    input_ = FrameData(1, std::vector<BaseDataPtr>{rois});
+    run_data_ = CNNMethodRunData();
+    run_data_.input = &input_;
+    cache_.Lookup(&run_data_);
+
+    auto slot = std::make_shared<BaseDataVector>();
+    for (size_t i = 0; i < boxes.size(); i++) {
+      auto age = std::make_shared<XRocData<Age>>();
+      if (run_data_.cached_output[0][i].empty()) {
+        age->value.value = value;
+      } else {
+        age->state_ = DataState::INVALID;
+      }
+      slot->datas_.push_back(age);
+    }
+    run_data_.output = FrameData(1, std::vector<BaseDataPtr>{slot});
+    cache_.Update(&run_data_);
+    return slot;
+  }
+
+  bool Hit(size_t roi_idx) const {
+    return !run_data_.cached_output[0][roi_idx].empty();
+  }
+
+  static int AgeOf(const std::shared_ptr<BaseDataVector> &slot, size_t i) {
+    return std::static_pointer_cast<XRocData<Age>>(slot->datas_[i])
+        ->value.value;
+  }
+
+  AttributeCache cache_;
+  FrameData input_;
+  CNNMethodRunData run_data_;
+};
+}  // namespace
+
+TEST_F(AttributeCacheTest, HitAndMiss) {
+  auto slot = Run({BBox(0, 0, 100, 100, 1, 1), BBox(200, 0, 300, 100, 1, -1)},
+                  20);
+  EXPECT_FALSE(Hit(0));
+  EXPECT_EQ(20, AgeOf(slot, 0));
+
+  slot = Run({BBox(2, 2, 102, 102, 1, 1), BBox(200, 0, 300, 100, 1, -1)}, 30);
+  EXPECT_TRUE(Hit(0));
+  // a box without track id is never cached
+  EXPECT_FALSE(Hit(1));
+  EXPECT_EQ(20, AgeOf(slot, 0));
+  EXPECT_EQ(30, AgeOf(slot, 1));
+  EXPECT_EQ(DataState::VALID, slot->datas_[0]->state_);
+}
+
+TEST_F(AttributeCacheTest, HitIsACopy) {
+  auto first = Run({BBox(0, 0, 100, 100, 1, 1)}, 20);
+  auto second = Run({BBox(0, 0, 100, 100, 1, 1)}, 30);
+  auto third = Run({BBox(0, 0, 100, 100, 1, 1)}, 40);
+  ASSERT_TRUE(Hit(0));
+  EXPECT_NE(first->datas_[0], second->datas_[0]);
+  EXPECT_NE(second->datas_[0], third->datas_[0]);
+
+  // a consumer changing its frame does not change the cache
+  first->datas_[0]->state_ = DataState::FILTERED;
+  std::static_pointer_cast<XRocData<Age>>(second->datas_[0])->value.value = 0;
+  auto fourth = Run({BBox(0, 0, 100, 100, 1, 1)}, 50);
+  EXPECT_EQ(20, AgeOf(fourth, 0));
+  EXPECT_EQ(DataState::VALID, fourth->datas_[0]->state_);
+}
+
+TEST_F(AttributeCacheTest, BoxChange) {
+  Run({BBox(0, 0, 100, 100, 1, 1)}, 20);
+  // iou 0.67
+  auto slot = Run({BBox(20, 0, 120, 100, 1, 1)}, 30);
+  EXPECT_FALSE(Hit(0));
+  EXPECT_EQ(30, AgeOf(slot, 0));
+
+  // iou 0.8 but 25% wider
+  slot = Run({BBox(20, 0, 145, 100, 1, 1)}, 40);
+  EXPECT_FALSE(Hit(0));
+  EXPECT_EQ(40, AgeOf(slot, 0));
+
+  slot = Run({BBox(20, 0, 145, 100, 1, 1)}, 50);
+  EXPECT_TRUE(Hit(0));
+  EXPECT_EQ(40, AgeOf(slot, 0));
+}
+
+TEST_F(AttributeCacheTest, MaxAge) {
+  const BBox box(0, 0, 100, 100, 1, 1);
+  Run({box}, 20);
+  for (int i = 0; i < 3; i++) {
+    Run({box}, 30);
+    EXPECT_TRUE(Hit(0));
+  }
+  // served 3 frames, predicted again
+  auto slot = Run({box}, 30);
+  EXPECT_FALSE(Hit(0));
+  EXPECT_EQ(30, AgeOf(slot, 0));
+  slot = Run({box}, 40);
+  EXPECT_TRUE(Hit(0));
+  EXPECT_EQ(30, AgeOf(slot, 0));
+}
+
+TEST_F(AttributeCacheTest, Eviction) {
+  const BBox box(0, 0, 100, 100, 1, 1);
+  const BBox other(300, 0, 400, 100, 1, 2);
+  Run({box}, 20);
+  // missed for max_age frames, still cached
+  for (int i = 0; i < 3; i++) {
+    Run({other}, 30);
+  }
+  auto slot = Run({box}, 40);
+  EXPECT_TRUE(Hit(0));
+  EXPECT_EQ(20, AgeOf(slot, 0));
+
+  // missed for more than max_age frames, dropped
+  for (int i = 0; i < 4; i++) {
+    Run({other}, 30);
+  }
+  slot = Run({box}, 50);
+  EXPECT_FALSE(Hit(0));
+  EXPECT_EQ(50, AgeOf(slot, 0));
+}
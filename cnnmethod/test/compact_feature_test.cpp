@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @file compact_feature_test.cpp
+ * @brief fused normalization and int8/fp16 round trip of CompactFeature
+ * @author agent
+ * @email agent@local
+ * @date 2026/10/19
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "hobotxsdk/compact_feature.h"
+
+using HobotXRoc::CompactFeature;
+
+namespace {
+const int kDim = 128;
+
+std::vector<float> MakeFeature() {
+  std::vector<float> values(kDim);
+  for (int i = 0; i < kDim; i++) {
+    values[i] = std::sin(i * 0.37f) * (i % 7 + 1);
+  }
+  return values;
+}
+
+std::vector<float> Reference(const std::vector<float> &values) {
+  double sum = 0;
+  for (auto v : values) {
+    sum += v * v;
+  }
+  std::vector<float> normalized(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    normalized[i] = values[i] / std::sqrt(sum);
+  }
+  return normalized;
+}
+}  // namespace
+
+TEST(CompactFeatureTest, Normalize) {
+  auto values = MakeFeature();
+  auto expected = Reference(values);
+  std::vector<float> normalized(kDim);
+  CompactFeature::Normalize(values.data(), kDim, normalized.data());
+  float sum = 0;
+  for (int i = 0; i < kDim; i++) {
+    EXPECT_NEAR(expected[i], normalized[i], 1e-6);
+    sum += normalized[i] * normalized[i];
+  }
+  EXPECT_NEAR(1.0f, sum, 1e-5);
+
+  // in place
+  CompactFeature::Normalize(values.data(), kDim, values.data());
+  EXPECT_EQ(normalized, values);
+}
+
+TEST(CompactFeatureTest, Int8RoundTrip) {
+  auto values = MakeFeature();
+  auto expected = Reference(values);
+  CompactFeature feature;
+  feature.Encode(values.data(), kDim, CompactFeature::Format::INT8);
+  EXPECT_EQ(CompactFeature::Format::INT8, feature.format);
+  EXPECT_EQ(kDim, feature.dim);
+  ASSERT_EQ(static_cast<size_t>(kDim), feature.data.size());
+  EXPECT_GT(feature.scale, 0.0f);
+
+  std::vector<float> decoded;
+  feature.ToFloat(&decoded);
+  ASSERT_EQ(static_cast<size_t>(kDim), decoded.size());
+  float max_abs = 0;
+  for (int i = 0; i < kDim; i++) {
+    EXPECT_NEAR(expected[i], decoded[i], feature.scale / 2 + 1e-6);
+    max_abs = std::max(max_abs, std::fabs(decoded[i]));
+  }
+  // the largest component uses the full int8 range
+  EXPECT_NEAR(127 * feature.scale, max_abs, 1e-6);
+}
+
+TEST(CompactFeatureTest, Fp16RoundTrip) {
+  auto values = MakeFeature();
+  auto expected = Reference(values);
+  CompactFeature feature;
+  feature.Encode(values.data(), kDim, CompactFeature::Format::FP16);
+  EXPECT_EQ(CompactFeature::Format::FP16, feature.format);
+  ASSERT_EQ(kDim * sizeof(uint16_t), feature.data.size());
+
+  std::vector<float> decoded;
+  feature.ToFloat(&decoded);
+  for (int i = 0; i < kDim; i++) {
+    // 11 significant bits
+    EXPECT_NEAR(expected[i], decoded[i], std::fabs(expected[i]) / 1024 + 1e-4);
+  }
+}
+
+TEST(CompactFeatureTest, Half) {
+  EXPECT_EQ(0x3c00, CompactFeature::FloatToHalf(1.0f));
+  EXPECT_EQ(0xc000, CompactFeature::FloatToHalf(-2.0f));
+  EXPECT_EQ(0x7c00, CompactFeature::FloatToHalf(1e6f));
+  EXPECT_EQ(0x0000, CompactFeature::FloatToHalf(1e-8f));
+  EXPECT_FLOAT_EQ(0.5f, CompactFeature::HalfToFloat(0x3800));
+  EXPECT_FLOAT_EQ(-1.0f, CompactFeature::HalfToFloat(0xbc00));
+}
+
+TEST(CompactFeatureTest, ZeroFeature) {
+  std::vector<float> values(kDim, 0.0f);
+  CompactFeature feature;
+  feature.Encode(values.data(), kDim, CompactFeature::Format::INT8);
+  EXPECT_EQ(0.0f, feature.scale);
+  std::vector<float> decoded;
+  feature.ToFloat(&decoded);
+  for (auto v : decoded) {
+    EXPECT_EQ(0.0f, v);
+  }
+}
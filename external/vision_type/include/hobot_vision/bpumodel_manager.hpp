@@ -13,13 +13,67 @@
 #define HOBOT_VISION_BPUMODEL_MANAGER_HPP_
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "bpu_predict/bpu_predict.h"
 #include "hobotlog/hobotlog.hpp"
 
 namespace hobot {
 namespace vision {
+/**
+ * @brief pool of empty bpu output buffers of one model. Buffers are checked
+ * out per target (layer_num handles each) and returned after the output is
+ * consumed, so the pool grows to the high-water mark of concurrent targets.
+ */
+class BPUOutputBufferPool {
+ public:
+  explicit BPUOutputBufferPool(int layer_num) : layer_num_(layer_num) {}
+  ~BPUOutputBufferPool() {
+    for (auto &buf : free_bufs_) {
+      BPU_freeBPUBuffer(buf);
+    }
+    free_bufs_.clear();
+  }
+
+  int LayerNum() const { return layer_num_; }
+
+  // append target_num * layer_num buffers to bufs
+  void Get(int target_num, std::vector<BPU_Buffer_Handle> *bufs) {
+    size_t need = static_cast<size_t>(target_num) * layer_num_;
+    bufs->reserve(bufs->size() + need);
+    std::lock_guard<std::mutex> lck(mutex_);
+    while (need > 0 && !free_bufs_.empty()) {
+      bufs->push_back(free_bufs_.back());
+      free_bufs_.pop_back();
+      need--;
+    }
+    for (; need > 0; need--) {
+      bufs->push_back(BPU_createEmptyBPUBuffer());
+      allocated_num_++;
+    }
+  }
+
+  // give back all buffers of bufs, bufs is cleared
+  void Put(std::vector<BPU_Buffer_Handle> *bufs) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    free_bufs_.insert(free_bufs_.end(), bufs->begin(), bufs->end());
+    bufs->clear();
+  }
+
+  size_t AllocatedNum() {
+    std::lock_guard<std::mutex> lck(mutex_);
+    return allocated_num_;
+  }
+
+ private:
+  int layer_num_;
+  size_t allocated_num_ = 0;
+  std::vector<BPU_Buffer_Handle> free_bufs_;
+  std::mutex mutex_;
+};
+
 class BPUModelManager {
  public:
   static BPUModelManager &Get() {
@@ -54,12 +108,31 @@ class BPUModelManager {
         auto bpu_handle = model_map_[model_path].first;
         BPU_release(bpu_handle);
         model_map_.erase(model_path);
+        buf_pool_map_.erase(model_path);
       }
     }
   }
+
+  // output buffer pool shared by all users of model_name in model_path
+  std::shared_ptr<BPUOutputBufferPool> GetOutputBufferPool(
+      const std::string &model_path, const std::string &model_name,
+      int layer_num) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    auto &pool = buf_pool_map_[model_path][model_name];
+    if (!pool) {
+      pool = std::make_shared<BPUOutputBufferPool>(layer_num);
+    }
+    HOBOT_CHECK(pool->LayerNum() == layer_num)
+        << "output layer num mismatch of model " << model_name;
+    return pool;
+  }
+
  private:
   std::mutex mutex_;
   std::map<std::string, std::pair<BPUHandle, int>> model_map_;
+  std::map<std::string,
+           std::map<std::string, std::shared_ptr<BPUOutputBufferPool>>>
+      buf_pool_map_;
 };
 }  // namespace vision
 }  // namespace hobot
@@ -18,8 +18,10 @@
 #include <utility>
 #include <list>
 #include <algorithm>
+#include <cstdint>
 #include "hobotxroc/method.h"
 #include "horizon/vision_type/vision_type.hpp"
+#include "FaceSnapFilterMethod/area_grid_index.hpp"
 
 namespace HobotXRoc {
 
@@ -250,9 +252,7 @@ class FaceSnapFilterMethod : public Method {
   bool IsWithinSnapArea(const float &x1,
                         const float &y1,
                         const float &x2,
-                        const float &y2,
-                        const int &image_width,
-                        const int &image_height);
+                        const float &y2);
   /**
    * if not in the blacklist area, return false
    * */
@@ -274,25 +274,29 @@ class FaceSnapFilterMethod : public Method {
 
   BaseDataVectorPtr ConstructFilterOutputSlot0(const size_t &num);
 
+  typedef BaseDataPtr (*ElementCopier)(const BaseDataPtr &);
+
   template<typename T>
-  BaseDataVectorPtr CopyAttribute(const BaseDataVectorPtr &attr) {
-    BaseDataVectorPtr ret = std::make_shared<BaseDataVector>();
-    int attr_size = attr->datas_.size();
-    if (0 == attr_size) {
-      return ret;
-    }
-    for (auto data : attr->datas_) {
-      auto actual_data = std::static_pointer_cast<T>(data);
-      std::shared_ptr<T> copy_data = std::make_shared<T>();
-      *copy_data = *actual_data;
-      ret->datas_.push_back(std::static_pointer_cast<BaseData>(copy_data));
-    }
-    return ret;
+  static BaseDataPtr CopyElement(const BaseDataPtr &data) {
+    auto actual_data = std::static_pointer_cast<T>(data);
+    return std::static_pointer_cast<BaseData>(
+        std::make_shared<T>(*actual_data));
   }
 
-  BaseDataVectorPtr CopyAttribute(\
-              const BaseDataVectorPtr &attr,
-              const std::string &data_type);
+  /**
+   * element copier of each input slot, resolved once per frame
+   * */
+  std::vector<ElementCopier> GetElementCopiers(size_t frame_input_size) const;
+
+  /**
+   * output elements share the input ones until their state changes,
+   * the first change replaces the shared element by a copy
+   * */
+  void SetOutputState(const std::vector<BaseDataVectorPtr> &input_slot,
+                      const std::vector<BaseDataVectorPtr> &output_slot,
+                      const std::vector<ElementCopier> &copiers,
+                      size_t output_idx, size_t face_idx,
+                      DataState state) const;
 
 
  private:
@@ -320,20 +324,79 @@ class FaceSnapFilterMethod : public Method {
                    std::vector<BaseDataVectorPtr> *p_output_slot,
                    bool pass_through);
 
+  /**
+   * one check of isValid. Stages run in the order of their expected cost
+   * to reject a face (cost / fail rate, from running pass-rate statistics),
+   * the failed stage with the smallest priority decides the error code so
+   * the result is the same as checking in priority order.
+   * */
+  enum class FilterStageType {
+    BLACK_LIST,
+    WHITE_LIST,
+    FACE_CONFIDENCE,
+    SIZE,
+    SNAP_AREA,
+    EXPAND,
+    FRONTAL,
+    QUALITY,
+    OCCLUSION,
+    LANDMARK,
+    BRIGHTNESS,
+    ABNORMAL
+  };
+
+  struct FilterStage {
+    FilterStageType type;
+    size_t slot = 0;         // input slot read by the stage
+    int priority = 0;        // smaller wins when several stages fail
+    float cost = 1.f;        // rough relative cost of one check
+    float thr = 0.f;         // occlusion threshold of the slot
+    uint32_t evaluated = 0;
+    uint32_t passed = 0;
+  };
+
   int isValid(const std::vector<BaseDataVectorPtr> &input_slot,
                int face_idx);
 
+  void BuildFilterStages(size_t frame_input_size);
+
+  void UpdateStageThresholds();
+
+  void ReorderFilterStages();
+
+  bool PassStage(const FilterStage &stage,
+                 const std::vector<BaseDataVectorPtr> &input_slot,
+                 int face_idx, hobot::vision::BBox *box);
+
+  int StageErrCode(const FilterStage &stage);
+
+  void LogFiltered(const FilterStage &stage,
+                   const std::vector<BaseDataVectorPtr> &input_slot,
+                   int face_idx);
+
+  std::vector<FilterStage> stages_;
+  size_t stages_input_size_ = 0;
+  uint32_t faces_since_reorder_ = 0;
+
+  // the last json param applied in ProcessOneBatch
+  bool param_cached_ = false;
+  size_t param_hash_ = 0;
+  std::string param_content_;
+
   void ProcessOneBatch(const std::vector<BaseDataPtr> &batch_i,
                        std::vector<BaseDataPtr> *p_frame_output,
                        const std::shared_ptr<InputParam> &param_i);
 
   void BigFaceFilter(int frame_input_size, int face_size,
-      std::vector<BaseDataVectorPtr> *p_output_slot) const;
+      const std::vector<BaseDataVectorPtr> &input_slot,
+      std::vector<BaseDataVectorPtr> *p_output_slot,
+      const std::vector<ElementCopier> &copiers) const;
 
   void AttributeFilter(int frame_input_size,
                        int face_size,
                        const std::vector<BaseDataVectorPtr> &input_slot,
-                       const std::vector<BaseDataVectorPtr> &output_slot);
+                       const std::vector<BaseDataVectorPtr> &output_slot,
+                       const std::vector<ElementCopier> &copiers);
 
   int NormalizeRoi(hobot::vision::BBox *src,
                    float norm_ratio,
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief     uniform grid index of the filter areas
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.0.1
+ * @date      2026.10.19
+ */
+
+#ifndef FACESNAPFILTERMETHOD_AREA_GRID_INDEX_HPP_
+#define FACESNAPFILTERMETHOD_AREA_GRID_INDEX_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace HobotXRoc {
+
+/**
+ * Uniform grid over [0, width) x [0, height), each cell lists the areas
+ * overlapping it. Coordinates outside the image fall into the border cells.
+ * Area needs float members x1_, y1_, x2_, y2_. Built once when the
+ * parameters change, queries only visit the cells touched by a face.
+ */
+template <typename Area>
+class AreaGridIndex {
+ public:
+  template <typename Container>
+  void Build(const Container &areas, int width, int height) {
+    areas_.assign(areas.begin(), areas.end());
+    offsets_.clear();
+    items_.clear();
+    if (areas_.empty()) {
+      return;
+    }
+    // about one area per cell, at most kMaxCells per side
+    int cells = static_cast<int>(
+        std::ceil(std::sqrt(static_cast<float>(areas_.size()))));
+    cols_ = std::max(1, std::min(static_cast<int>(kMaxCells), cells));
+    rows_ = cols_;
+    cell_w_ = std::max(1.f, static_cast<float>(width)) / cols_;
+    cell_h_ = std::max(1.f, static_cast<float>(height)) / rows_;
+
+    bound_ = areas_[0];
+    for (const auto &area : areas_) {
+      bound_.x1_ = std::min(bound_.x1_, area.x1_);
+      bound_.y1_ = std::min(bound_.y1_, area.y1_);
+      bound_.x2_ = std::max(bound_.x2_, area.x2_);
+      bound_.y2_ = std::max(bound_.y2_, area.y2_);
+    }
+    // compressed rows: cell c lists items_[offsets_[c], offsets_[c + 1])
+    offsets_.assign(cols_ * rows_ + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+      std::vector<uint32_t> fill(offsets_.begin(), offsets_.end() - 1);
+      for (size_t i = 0; i < areas_.size(); i++) {
+        const auto &area = areas_[i];
+        int cx1 = Col(area.x1_), cx2 = Col(area.x2_);
+        int cy1 = Row(area.y1_), cy2 = Row(area.y2_);
+        for (int y = cy1; y <= cy2; y++) {
+          for (int x = cx1; x <= cx2; x++) {
+            int cell = y * cols_ + x;
+            if (pass == 0) {
+              offsets_[cell + 1]++;
+            } else {
+              items_[fill[cell]++] = static_cast<uint32_t>(i);
+            }
+          }
+        }
+      }
+      if (pass == 0) {
+        for (size_t c = 1; c < offsets_.size(); c++) {
+          offsets_[c] += offsets_[c - 1];
+        }
+        items_.resize(offsets_.back());
+      }
+    }
+  }
+
+  bool empty() const { return areas_.empty(); }
+
+  size_t size() const { return areas_.size(); }
+
+  /**
+   * true if pred(area) holds for an area overlapping [x1, x2] x [y1, y2],
+   * each area is tested at most once
+   */
+  template <typename Pred>
+  bool AnyOverlap(float x1, float y1, float x2, float y2, Pred pred) const {
+    if (areas_.empty() || x1 > bound_.x2_ || x2 < bound_.x1_
+        || y1 > bound_.y2_ || y2 < bound_.y1_) {
+      return false;
+    }
+    int cx1 = Col(x1), cx2 = Col(x2);
+    int cy1 = Row(y1), cy2 = Row(y2);
+    for (int y = cy1; y <= cy2; y++) {
+      for (int x = cx1; x <= cx2; x++) {
+        int cell = y * cols_ + x;
+        for (uint32_t k = offsets_[cell]; k < offsets_[cell + 1]; k++) {
+          const auto &area = areas_[items_[k]];
+          // an area spanning several queried cells is only tested in the
+          // first cell shared by the area and the query
+          if (x != std::max(cx1, Col(area.x1_))
+              || y != std::max(cy1, Row(area.y1_))) {
+            continue;
+          }
+          if (pred(area)) {
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  // true if pred(area) holds for an area whose cell contains (x, y)
+  template <typename Pred>
+  bool AnyAt(float x, float y, Pred pred) const {
+    if (areas_.empty() || x > bound_.x2_ || x < bound_.x1_
+        || y > bound_.y2_ || y < bound_.y1_) {
+      return false;
+    }
+    int cell = Row(y) * cols_ + Col(x);
+    for (uint32_t k = offsets_[cell]; k < offsets_[cell + 1]; k++) {
+      if (pred(areas_[items_[k]])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  static const int kMaxCells = 16;
+
+  int Col(float x) const { return Clamp(x / cell_w_, cols_); }
+  int Row(float y) const { return Clamp(y / cell_h_, rows_); }
+
+  static int Clamp(float pos, int cells) {
+    if (!(pos > 0)) {
+      return 0;
+    }
+    if (pos >= cells) {
+      return cells - 1;
+    }
+    return static_cast<int>(pos);
+  }
+
+  std::vector<Area> areas_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> items_;
+  Area bound_;
+  int cols_ = 1;
+  int rows_ = 1;
+  float cell_w_ = 1.f;
+  float cell_h_ = 1.f;
+};
+
+}  // namespace HobotXRoc
+
+#endif  // FACESNAPFILTERMETHOD_AREA_GRID_INDEX_HPP_
@@ -90,6 +90,7 @@ struct FaceSnapFilterParam : public HobotXRoc::InputParam {
           white_list_module.AddWhiteList(x1, y1, x2, y2);
         }
       }
+      BuildAreaIndex();
       if (ret) {
         return 0;
       } else {
@@ -198,6 +199,18 @@ struct FaceSnapFilterParam : public HobotXRoc::InputParam {
            << " roll: " << frontal_roll_thr;
   }
 
+  // compile the areas once, the filter queries the indexes per face
+  void BuildAreaIndex() {
+    black_area_index.Build(black_list_module.GetBlackAreaList(),
+                           image_width, image_height);
+    white_area_index.Build(white_list_module.GetWhiteAreaList(),
+                           image_width, image_height);
+    snap_area.x1_ = bound_thr_w;
+    snap_area.y1_ = bound_thr_h;
+    snap_area.x2_ = image_width - bound_thr_w;
+    snap_area.y2_ = image_height - bound_thr_h;
+  }
+
   std::string Format() override {
     return config_jv_all_.toStyledString();
   };
@@ -223,6 +236,9 @@ struct FaceSnapFilterParam : public HobotXRoc::InputParam {
       black_list_module;  // we will filter the snaps in the blacklist area
   WhiteListsModule
       white_list_module; // we will allow the snaps in the whitelist area
+  AreaGridIndex<BlackArea> black_area_index;
+  AreaGridIndex<WhiteArea> white_area_index;
+  WhiteArea snap_area;  // box edges must lie strictly inside
   int max_box_counts = 0;            // the max count of boxes
   int brightness_min = 0;
   int brightness_max = 4;
@@ -14,6 +14,7 @@
 #include <fstream>
 #include <algorithm>
 #include <memory>
+#include <functional>
 #include <json/json.h>
 
 #include "hobotlog/hobotlog.hpp"
@@ -98,8 +99,19 @@ void FaceSnapFilterMethod::ProcessOneBatch(
 
   if (param_i) {
     if (param_i->is_json_format_) {
-      int param_ret = UpdateParameter(param_i);
-      if (param_ret != 0)  return;
+      // the same param usually comes with every frame, parse it once
+      std::string content = param_i->Format();
+      size_t content_hash = std::hash<std::string>()(content);
+      if (!param_cached_ || content_hash != param_hash_
+          || content != param_content_) {
+        param_cached_ = false;
+        int param_ret = filter_param_->UpdateParameter(content);
+        if (param_ret != 0)  return;
+        UpdateStageThresholds();
+        param_cached_ = true;
+        param_hash_ = content_hash;
+        param_content_ = std::move(content);
+      }
     }
     if (param_i->Format() == "pass-through") {
       LOGI << "pass-through mode";
@@ -112,10 +124,13 @@ void FaceSnapFilterMethod::ProcessOneBatch(
       HOBOT_CHECK("BaseDataVector" == batch_i[i]->type_) << "idx: " << i;
     }
     Copy2Output(input_slot, &output_slot, false);
+    auto copiers = GetElementCopiers(frame_input_size);
     // do filter
-    AttributeFilter(frame_input_size, face_size, input_slot, output_slot);
+    AttributeFilter(frame_input_size, face_size, input_slot, output_slot,
+                    copiers);
     // final : big face mode
-    BigFaceFilter(frame_input_size, face_size, &output_slot);
+    BigFaceFilter(frame_input_size, face_size, input_slot, &output_slot,
+                  copiers);
   } else {
     Copy2Output(input_slot, &output_slot, true);
   }
@@ -130,7 +145,8 @@ void FaceSnapFilterMethod::ProcessOneBatch(
 void FaceSnapFilterMethod::AttributeFilter(
     int frame_input_size, int face_size,
     const std::vector<BaseDataVectorPtr> &input_slot,
-    const std::vector<BaseDataVectorPtr> &output_slot) {
+    const std::vector<BaseDataVectorPtr> &output_slot,
+    const std::vector<ElementCopier> &copiers) {
   for (int face_idx = 0; face_idx < face_size; ++face_idx) {
     int valid_code = isValid(input_slot, face_idx);
     if (valid_code == filter_param_->passed_err_code) {
@@ -144,9 +160,11 @@ void FaceSnapFilterMethod::AttributeFilter(
       // this face_confidence will be filtered
       for (int i = 1; i < frame_input_size + 1; ++i) {
         if (filter_param_->filter_status = 4) {
-          output_slot[i]->datas_[face_idx]->state_ = DataState::INVALID;
+          SetOutputState(input_slot, output_slot, copiers, i, face_idx,
+                         DataState::INVALID);
         } else {
-          output_slot[i]->datas_[face_idx]->state_ = DataState::FILTERED;
+          SetOutputState(input_slot, output_slot, copiers, i, face_idx,
+                         DataState::FILTERED);
         }
       }
     }
@@ -154,7 +172,9 @@ void FaceSnapFilterMethod::AttributeFilter(
 }
 
 void FaceSnapFilterMethod::BigFaceFilter(int frame_input_size, int face_size,
-    std::vector<BaseDataVectorPtr> *p_output_slot) const {
+    const std::vector<BaseDataVectorPtr> &input_slot,
+    std::vector<BaseDataVectorPtr> *p_output_slot,
+    const std::vector<ElementCopier> &copiers) const {
   auto &output_slot = *p_output_slot;
   if (filter_param_->max_box_counts) {
     std::vector<size_t> sorted_indexs;
@@ -187,8 +207,8 @@ void FaceSnapFilterMethod::BigFaceFilter(int frame_input_size, int face_size,
       xroc_desp->value = filter_param_->big_face_err_code;
       for (int i = 0; i < frame_input_size + 1; ++i) {
         FILTER_LOG(sorted_indexs[face_idx], "big face mode")
-        output_slot[i]->datas_[sorted_indexs[face_idx]]->state_ =
-            DataState::FILTERED;
+        SetOutputState(input_slot, output_slot, copiers, i,
+                       sorted_indexs[face_idx], DataState::FILTERED);
       }
     }
   }
@@ -196,154 +216,234 @@ void FaceSnapFilterMethod::BigFaceFilter(int frame_input_size, int face_size,
 
 int FaceSnapFilterMethod::isValid(
     const std::vector<BaseDataVectorPtr> &input_slot, int face_idx) {
-  auto frame_input_size = input_slot.size();
   // input: [face_box, pose, landmark, blue, brightness, eye_abnormalities,
   //         mouth_abnormal, left_eye, right_eye, left_brow, right_brow,
   //         forehead, left_cheek, right_check, nose, mouth, jaw]
+  if (stages_input_size_ != input_slot.size()) {
+    BuildFilterStages(input_slot.size());
+  }
+  if (++faces_since_reorder_ >= 64) {
+    ReorderFilterStages();
+  }
   auto face_box =
-      std::static_pointer_cast<XRocBBox>(input_slot[0]->datas_[face_idx]);
-  float x1 = face_box->value.x1;
-  float y1 = face_box->value.y1;
-  float x2 = face_box->value.x2;
-  float y2 = face_box->value.y2;
-  float box_score = face_box->value.score;
-
-  // judge filter
-  bool size = ReachSizeThreshold(x1, y1, x2, y2);
-
-  bool expand = ExpandThreshold(&(face_box->value));
-  bool has_pose = false, has_lmk = false;
+      static_cast<XRocBBox *>(input_slot[0]->datas_[face_idx].get());
+  const FilterStage *failed = nullptr;
+  for (auto &stage : stages_) {
+    // only a stage of higher priority can still change the result
+    if (failed && stage.priority > failed->priority) {
+      continue;
+    }
+    stage.evaluated++;
+    if (PassStage(stage, input_slot, face_idx, &(face_box->value))) {
+      stage.passed++;
+    } else {
+      failed = &stage;
+    }
+  }
+  if (!failed) {
+    return filter_param_->passed_err_code;
+  }
+  LogFiltered(*failed, input_slot, face_idx);
+  return StageErrCode(*failed);
+}
+
+void FaceSnapFilterMethod::BuildFilterStages(size_t frame_input_size) {
+  stages_.clear();
+  auto add_stage = [this](FilterStageType type, size_t slot, float cost) {
+    FilterStage stage;
+    stage.type = type;
+    stage.slot = slot;
+    stage.priority = static_cast<int>(type) * 64 + static_cast<int>(slot);
+    stage.cost = cost;
+    stages_.push_back(stage);
+  };
+  add_stage(FilterStageType::BLACK_LIST, 0, 4.f);
+  add_stage(FilterStageType::WHITE_LIST, 0, 2.f);
+  add_stage(FilterStageType::FACE_CONFIDENCE, 0, 1.f);
+  add_stage(FilterStageType::SIZE, 0, 1.f);
+  add_stage(FilterStageType::SNAP_AREA, 0, 1.f);
+  add_stage(FilterStageType::EXPAND, 0, 3.f);
   if (frame_input_size > 1) {
-    has_pose = true;
+    add_stage(FilterStageType::FRONTAL, 1, 3.f);
   }
   if (frame_input_size > 2) {
-    has_lmk = true;
+    add_stage(FilterStageType::LANDMARK, 2, 8.f);
   }
+  if (frame_input_size > 3) {
+    add_stage(FilterStageType::QUALITY, 3, 1.5f);
+  }
+  if (frame_input_size > 4) {
+    add_stage(FilterStageType::BRIGHTNESS, 4, 1.5f);
+  }
+  if (frame_input_size > 6) {
+    for (size_t i = 5; i < 7; i++) {
+      add_stage(FilterStageType::ABNORMAL, i, 1.5f);
+    }
+  }
+  for (size_t i = 7; i < frame_input_size && i < input_data_types_.size();
+       i++) {
+    add_stage(FilterStageType::OCCLUSION, i, 1.5f);
+  }
+  stages_input_size_ = frame_input_size;
+  UpdateStageThresholds();
+  ReorderFilterStages();
+}
 
-  float pitch = 0, yaw = 0, roll = 0, quality_score = 0;
-
-  bool pos = !has_pose;
-  if (has_pose) {
-    auto pose = std::static_pointer_cast<XRocPose3D>(
-        input_slot[1]->datas_[face_idx]);
-    if (pose->state_ == DataState::VALID) {
-      pitch = pose->value.pitch;
-      yaw = pose->value.yaw;
-      roll = pose->value.roll;
-      pos = ReachPoseThreshold(pitch, yaw, roll);
+void FaceSnapFilterMethod::UpdateStageThresholds() {
+  for (auto &stage : stages_) {
+    if (stage.type == FilterStageType::OCCLUSION) {
+      stage.thr = GetOccludeVal(input_data_types_[stage.slot]);
     }
   }
+}
 
-  bool lmk_verification = !has_lmk;
-  if (has_lmk) {
-    auto lmk = std::static_pointer_cast<XRocLandmarks>
-        (input_slot[2]->datas_[face_idx]);
-    if (lmk->state_ == DataState::VALID) {
-      lmk_verification = LmkVerification(lmk);
+void FaceSnapFilterMethod::ReorderFilterStages() {
+  faces_since_reorder_ = 0;
+  for (auto &stage : stages_) {
+    // forget old statistics so that the order follows the scene
+    if (stage.evaluated > 4096) {
+      stage.evaluated /= 2;
+      stage.passed /= 2;
     }
   }
+  // expected cost to reject a face, smoothed pass rate is below 1
+  auto rank = [](const FilterStage &stage) {
+    float pass_rate = (stage.passed + 1.f) / (stage.evaluated + 2.f);
+    return stage.cost / (1.f - pass_rate);
+  };
+  std::stable_sort(stages_.begin(), stages_.end(),
+                   [&rank](const FilterStage &lhs, const FilterStage &rhs) {
+                     return rank(lhs) < rank(rhs);
+                   });
+}
 
-  bool face_confidence = PassPostVerification(box_score);
-  bool is_within_snap_area = IsWithinSnapArea(x1,
-                                              y1,
-                                              x2,
-                                              y2,
-                                              filter_param_->image_width,
-                                              filter_param_->image_height);
-  bool is_within_blacklist = IsWithinBlackListArea(x1, y1, x2, y2);
-  bool is_within_whitelist = IsWithinWhiteListArea(x1, y1, x2, y2);
-
-  bool quality_verification = true;
-  if (input_slot.size() > 3) {
-    auto quality =
-        std::static_pointer_cast<XRocQuality>(input_slot[3]->datas_[face_idx]);
-    quality_score =  quality->value.score;
-    quality_verification = ReachQualityThreshold(quality->value.score);
-  }
-
-  int brightness_val = 0;
-  bool brightness_valid = true;
-  if (input_slot.size() > 4) {
-    auto brightness = std::static_pointer_cast<XRocAttribute>(
-            input_slot[4]->datas_[face_idx]);
-    brightness_val = brightness->value.value;
-    brightness_valid = ValidBrightness(brightness_val);
-  }
-  if (is_within_blacklist) {
-    FILTER_LOG(face_idx, "blacklist area")
-    return filter_param_->black_list_err_code;
-  }
-  if (!is_within_whitelist) {
-    FILTER_LOG(face_idx, "whitelist area")
-    return filter_param_->white_list_err_code;
-  }
-  if (!face_confidence) {
-    FILTER_LOG_VALUE(face_idx, "face_confidence", box_score)
-    return filter_param_->pv_thr_err_code;
-  }
-  if (!size) {
-    FILTER_LOG_VALUE(face_idx, "size", size)
-    return filter_param_->snap_size_thr_err_code;
-  }
-  if (!is_within_snap_area) {
-    FILTER_LOG(face_idx, "bound")
-    return filter_param_->snap_area_err_code;
-  }
-  if (!expand) {
-    FILTER_LOG(face_idx, "expand")
-    return filter_param_->expand_thr_err_code;
-  }
-
-  if (!pos) {
-    std::string frontal_str = "pitch: " + std::to_string(pitch)
-        + " yaw: " + std::to_string(yaw)
-        + " roll: " + std::to_string(roll);
-    FILTER_LOG_VALUE(face_idx, "frontal area", frontal_str)
-    return filter_param_->frontal_thr_err_code;
-  }
-  if (!quality_verification) {
-    FILTER_LOG_VALUE(face_idx, "quality", quality_score)
-    return filter_param_->quality_thr_err_code;
-  }
-  bool passed_occluded_condition = true;
-  if (input_slot.size() > 7) {
-    for (size_t i = 7; i < input_slot.size(); i++) {
-      auto quality = std::static_pointer_cast<XRocAttribute>(
-          input_slot[i]->datas_[face_idx]);
-      std::string occlude_name = input_data_types_[i];
-      auto thr = GetOccludeVal(occlude_name);
-      passed_occluded_condition =
-          !IsOccluded(quality->value.score, thr) && passed_occluded_condition;
-      if (!passed_occluded_condition) {
-        FILTER_LOG_VALUE(face_idx, occlude_name, quality->value.score)
-        return GetOccludeErrCode(occlude_name);
+bool FaceSnapFilterMethod::PassStage(
+    const FilterStage &stage,
+    const std::vector<BaseDataVectorPtr> &input_slot,
+    int face_idx, hobot::vision::BBox *box) {
+  const auto &data = input_slot[stage.slot]->datas_[face_idx];
+  switch (stage.type) {
+    case FilterStageType::BLACK_LIST:
+      return !IsWithinBlackListArea(box->x1, box->y1, box->x2, box->y2);
+    case FilterStageType::WHITE_LIST:
+      return IsWithinWhiteListArea(box->x1, box->y1, box->x2, box->y2);
+    case FilterStageType::FACE_CONFIDENCE:
+      return PassPostVerification(box->score);
+    case FilterStageType::SIZE:
+      return ReachSizeThreshold(box->x1, box->y1, box->x2, box->y2);
+    case FilterStageType::SNAP_AREA:
+      return IsWithinSnapArea(box->x1, box->y1, box->x2, box->y2);
+    case FilterStageType::EXPAND:
+      return ExpandThreshold(box);
+    case FilterStageType::FRONTAL: {
+      if (data->state_ != DataState::VALID) {
+        return false;
       }
+      auto &pose = static_cast<XRocPose3D *>(data.get())->value;
+      return ReachPoseThreshold(pose.pitch, pose.yaw, pose.roll);
     }
-  }
-  if (!lmk_verification) {
-    FILTER_LOG(face_idx, "landmark")
-    return filter_param_->lmk_thr_err_code;
-  }
-  if (!brightness_valid) {
-    FILTER_LOG_VALUE(face_idx, "brightness", brightness_val)
-    return filter_param_->brightness_err_code;
-  }
-  bool passed_abnormal_condition = true;
-  if (input_slot.size() > 6) {
-    for (size_t i = 5; i < 7; i++) {
-      auto quality = std::static_pointer_cast<XRocAttribute>(
-          input_slot[i]->datas_[face_idx]);
-      passed_abnormal_condition =
-          !IsAbnormal(quality->value.score) && passed_abnormal_condition;
-      if (!passed_abnormal_condition) {
-        FILTER_LOG_VALUE(face_idx, input_data_types_[i], quality->value.score)
-        return filter_param_->abnormal_thr_err_code;
+    case FilterStageType::LANDMARK: {
+      if (data->state_ != DataState::VALID) {
+        return false;
       }
+      return LmkVerification(std::static_pointer_cast<XRocLandmarks>(data));
     }
+    case FilterStageType::QUALITY:
+      return ReachQualityThreshold(
+          static_cast<XRocQuality *>(data.get())->value.score);
+    case FilterStageType::BRIGHTNESS:
+      return ValidBrightness(
+          static_cast<XRocAttribute *>(data.get())->value.value);
+    case FilterStageType::ABNORMAL:
+      return !IsAbnormal(
+          static_cast<XRocAttribute *>(data.get())->value.score);
+    case FilterStageType::OCCLUSION:
+      return !IsOccluded(
+          static_cast<XRocAttribute *>(data.get())->value.score, stage.thr);
+  }
+  return true;
+}
+
+int FaceSnapFilterMethod::StageErrCode(const FilterStage &stage) {
+  switch (stage.type) {
+    case FilterStageType::BLACK_LIST:
+      return filter_param_->black_list_err_code;
+    case FilterStageType::WHITE_LIST:
+      return filter_param_->white_list_err_code;
+    case FilterStageType::FACE_CONFIDENCE:
+      return filter_param_->pv_thr_err_code;
+    case FilterStageType::SIZE:
+      return filter_param_->snap_size_thr_err_code;
+    case FilterStageType::SNAP_AREA:
+      return filter_param_->snap_area_err_code;
+    case FilterStageType::EXPAND:
+      return filter_param_->expand_thr_err_code;
+    case FilterStageType::FRONTAL:
+      return filter_param_->frontal_thr_err_code;
+    case FilterStageType::LANDMARK:
+      return filter_param_->lmk_thr_err_code;
+    case FilterStageType::QUALITY:
+      return filter_param_->quality_thr_err_code;
+    case FilterStageType::BRIGHTNESS:
+      return filter_param_->brightness_err_code;
+    case FilterStageType::ABNORMAL:
+      return filter_param_->abnormal_thr_err_code;
+    case FilterStageType::OCCLUSION:
+      return GetOccludeErrCode(input_data_types_[stage.slot]);
   }
   return filter_param_->passed_err_code;
 }
 
+void FaceSnapFilterMethod::LogFiltered(
+    const FilterStage &stage,
+    const std::vector<BaseDataVectorPtr> &input_slot, int face_idx) {
+  const auto &data = input_slot[stage.slot]->datas_[face_idx];
+  auto &box = static_cast<XRocBBox *>(
+      input_slot[0]->datas_[face_idx].get())->value;
+  switch (stage.type) {
+    case FilterStageType::BLACK_LIST:
+      FILTER_LOG(face_idx, "blacklist area")
+      break;
+    case FilterStageType::WHITE_LIST:
+      FILTER_LOG(face_idx, "whitelist area")
+      break;
+    case FilterStageType::FACE_CONFIDENCE:
+      FILTER_LOG_VALUE(face_idx, "face_confidence", box.score)
+      break;
+    case FilterStageType::SIZE:
+      FILTER_LOG_VALUE(face_idx, "size", box.Width() << "x" << box.Height())
+      break;
+    case FilterStageType::SNAP_AREA:
+      FILTER_LOG(face_idx, "bound")
+      break;
+    case FilterStageType::EXPAND:
+      FILTER_LOG(face_idx, "expand")
+      break;
+    case FilterStageType::FRONTAL: {
+      auto &pose = static_cast<XRocPose3D *>(data.get())->value;
+      FILTER_LOG_VALUE(face_idx, "frontal area", "pitch: " << pose.pitch
+                       << " yaw: " << pose.yaw << " roll: " << pose.roll)
+      break;
+    }
+    case FilterStageType::LANDMARK:
+      FILTER_LOG(face_idx, "landmark")
+      break;
+    case FilterStageType::QUALITY:
+      FILTER_LOG_VALUE(face_idx, "quality",
+                       static_cast<XRocQuality *>(data.get())->value.score)
+      break;
+    case FilterStageType::BRIGHTNESS:
+      FILTER_LOG_VALUE(face_idx, "brightness",
+                       static_cast<XRocAttribute *>(data.get())->value.value)
+      break;
+    case FilterStageType::ABNORMAL:
+    case FilterStageType::OCCLUSION:
+      FILTER_LOG_VALUE(face_idx, input_data_types_[stage.slot],
+                       static_cast<XRocAttribute *>(data.get())->value.score)
+      break;
+  }
+}
+
 void FaceSnapFilterMethod::Copy2Output(
               const std::vector<BaseDataVectorPtr> &input_slot,
               std::vector<BaseDataVectorPtr> *p_output_slot,
@@ -357,56 +457,56 @@ void FaceSnapFilterMethod::Copy2Output(
   } else {
     if (frame_input_size > 0) {
       output_slot[0] = ConstructFilterOutputSlot0(input_slot[0]->datas_.size());
-      output_slot[1] = CopyAttribute<XRocBBox>(input_slot[0]);
-    }
-    if (frame_input_size > 1) {
-      output_slot[2] = CopyAttribute<XRocPose3D>(input_slot[1]);
     }
-    if (frame_input_size > 2) {
-      output_slot[3] = CopyAttribute<XRocLandmarks>(input_slot[2]);
-    }
-    for (size_t i = 3; i < frame_input_size; ++i) {
-      output_slot[i + 1] = CopyAttribute(input_slot[i], input_data_types_[i]);
+    // new vectors sharing the input elements, see SetOutputState
+    for (size_t i = 0; i < frame_input_size; ++i) {
+      output_slot[i + 1] = std::make_shared<BaseDataVector>();
+      output_slot[i + 1]->datas_ = input_slot[i]->datas_;
     }
   }
 }
 
 void FaceSnapFilterMethod::Finalize() {}
 
-BaseDataVectorPtr FaceSnapFilterMethod::CopyAttribute(\
-              const BaseDataVectorPtr &attr,
-              const std::string &data_type) {
-  BaseDataVectorPtr ret = std::make_shared<BaseDataVector>();
-  int attr_size = attr->datas_.size();
-  if (0 == attr_size) {
-    return ret;
+std::vector<FaceSnapFilterMethod::ElementCopier>
+FaceSnapFilterMethod::GetElementCopiers(size_t frame_input_size) const {
+  std::vector<ElementCopier> copiers(frame_input_size,
+                                     &CopyElement<XRocAttribute>);
+  if (frame_input_size > 0) {
+    copiers[0] = &CopyElement<XRocBBox>;
   }
-
-  for (const auto& data : attr->datas_) {
+  if (frame_input_size > 1) {
+    copiers[1] = &CopyElement<XRocPose3D>;
+  }
+  if (frame_input_size > 2) {
+    copiers[2] = &CopyElement<XRocLandmarks>;
+  }
+  for (size_t i = 3; i < frame_input_size && i < input_data_types_.size();
+       ++i) {
+    const auto &data_type = input_data_types_[i];
     if ("blur" == data_type) {
-      auto actual_data = std::static_pointer_cast<XRocQuality>(data);
-      std::shared_ptr<XRocQuality> copy_data = std::make_shared<XRocQuality>();
-      *copy_data = *actual_data;
-      ret->datas_.push_back(std::static_pointer_cast<BaseData>(copy_data));
+      copiers[i] = &CopyElement<XRocQuality>;
     } else if ("age" == data_type) {
-      auto actual_data = std::static_pointer_cast<XRocAge>(data);
-      std::shared_ptr<XRocAge> copy_data = std::make_shared<XRocAge>();
-      *copy_data = *actual_data;
-      ret->datas_.push_back(std::static_pointer_cast<BaseData>(copy_data));
+      copiers[i] = &CopyElement<XRocAge>;
     } else if ("gender" == data_type) {
-      auto actual_data = std::static_pointer_cast<XRocGender>(data);
-      std::shared_ptr<XRocGender> copy_data = std::make_shared<XRocGender>();
-      *copy_data = *actual_data;
-      ret->datas_.push_back(std::static_pointer_cast<BaseData>(copy_data));
-    } else {
-      auto actual_data = std::static_pointer_cast<XRocAttribute>(data);
-      std::shared_ptr<XRocAttribute> copy_data =
-          std::make_shared<XRocAttribute>();
-      *copy_data = *actual_data;
-      ret->datas_.push_back(std::static_pointer_cast<BaseData>(copy_data));
+      copiers[i] = &CopyElement<XRocGender>;
     }
   }
-  return ret;
+  return copiers;
+}
+
+void FaceSnapFilterMethod::SetOutputState(
+    const std::vector<BaseDataVectorPtr> &input_slot,
+    const std::vector<BaseDataVectorPtr> &output_slot,
+    const std::vector<ElementCopier> &copiers,
+    size_t output_idx, size_t face_idx, DataState state) const {
+  auto &data = output_slot[output_idx]->datas_[face_idx];
+  // slot 0 is owned by the filter, others are copied on first change
+  if (output_idx > 0
+      && data == input_slot[output_idx - 1]->datas_[face_idx]) {
+    data = copiers[output_idx - 1](data);
+  }
+  data->state_ = state;
 }
 
 bool FaceSnapFilterMethod::ReachPoseThreshold(\
@@ -515,54 +615,38 @@ bool FaceSnapFilterMethod::LmkVerification(\
 bool FaceSnapFilterMethod::IsWithinSnapArea(const float &x1,
                                             const float &y1,
                                             const float &x2,
-                                            const float &y2,
-                                            const int &image_width,
-                                            const int &image_height) {
-  return (x1 > filter_param_->bound_thr_w)
-      && ((image_width - x2) > filter_param_->bound_thr_w)
-      && (y1 > filter_param_->bound_thr_h)
-      && ((image_height - y2) > filter_param_->bound_thr_h);
+                                            const float &y2) {
+  const auto &snap_area = filter_param_->snap_area;
+  return (x1 > snap_area.x1_) && (x2 < snap_area.x2_)
+      && (y1 > snap_area.y1_) && (y2 < snap_area.y2_);
 }
 
 bool FaceSnapFilterMethod::IsWithinBlackListArea(const float &x1,
                                                  const float &y1,
                                                  const float &x2,
                                                  const float &y2) {
-  if (filter_param_->black_list_module.GetBlackAreaList().empty()) {
-    return false;
-  }
-  for (auto &black_area : \
-           filter_param_->black_list_module.GetBlackAreaList()) {
-    if (filter_param_->black_list_module.IsSameBBox(x1,
-                                                    y1,
-                                                    x2,
-                                                    y2,
-                                                    black_area)) {
-      return true;
-    }
-  }
-  return false;
+  auto &black_list = filter_param_->black_list_module;
+  return filter_param_->black_area_index.AnyOverlap(
+      x1, y1, x2, y2, [&](const BlackArea &black_area) {
+        return black_list.IsSameBBox(x1, y1, x2, y2, black_area);
+      });
 }
 
 bool FaceSnapFilterMethod::IsWithinWhiteListArea(const float &x1,
                                                  const float &y1,
                                                  const float &x2,
                                                  const float &y2) {
-  if (filter_param_->white_list_module.GetWhiteAreaList().empty()) {
+  const auto &white_area_index = filter_param_->white_area_index;
+  if (white_area_index.empty()) {
     return true;
   }
-
-  for (const auto &white_area : \
-           filter_param_->white_list_module.GetWhiteAreaList()) {
-    if (filter_param_->white_list_module.IsInZone(x1,
-                                                  y1,
-                                                  x2,
-                                                  y2,
-                                                  white_area)) {
-      return true;
-    }
-  }
-  return false;
+  // same center as WhiteListsModule::IsInZone
+  float c_x = x1 + (x2 - x1) * 0.5;
+  float c_y = y1 + (y2 - y1) * 0.5;
+  return white_area_index.AnyAt(
+      c_x, c_y, [&](const WhiteArea &white_area) {
+        return WhiteListsModule::IsInZone(x1, y1, x2, y2, white_area);
+      });
 }
 
 bool FaceSnapFilterMethod::ExpandThreshold(hobot::vision::BBox *box) {
@@ -576,7 +660,10 @@ bool FaceSnapFilterMethod::ExpandThreshold(hobot::vision::BBox *box) {
 int FaceSnapFilterMethod::UpdateParameter(InputParamPtr ptr) {
   if (ptr->is_json_format_) {
     std::string content = ptr->Format();
-    return filter_param_->UpdateParameter(content);
+    param_cached_ = false;
+    int ret = filter_param_->UpdateParameter(content);
+    UpdateStageThresholds();
+    return ret;
   } else {
     HOBOT_CHECK(0) << "only support json format config";
     return -1;
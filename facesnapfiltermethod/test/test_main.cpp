@@ -7,6 +7,7 @@
  * @date      2019.01.11
  */
 
+#include <cstdlib>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -420,6 +421,13 @@ TEST_F(FaceSnapFilterMethodTest, big_face_mode) {
     }
   }
   EXPECT_EQ(actual_size, 1);
+  // passed faces share the input, filtered ones are copied
+  EXPECT_EQ(output_box->datas_[1], face_box->datas_[1]);
+  EXPECT_NE(output_box->datas_[0], face_box->datas_[0]);
+  EXPECT_EQ(face_box->datas_[0]->state_, DataState::VALID);
+  EXPECT_EQ(output_box->datas_[0]->state_, DataState::FILTERED);
+  EXPECT_EQ(std::static_pointer_cast<XRocBBox>(output_box->datas_[0])
+                ->value.score, face_box_[0]->value.score);
 }
 
 TEST_F(FaceSnapFilterMethodTest, pass_through) {
@@ -469,4 +477,88 @@ TEST_F(FaceSnapFilterMethodTest, pass_through) {
   EXPECT_EQ(actual_size, 2);
 }
 
+TEST_F(FaceSnapFilterMethodTest, error_code_priority) {
+  FaceSnapFilterMethod method;
+  method.Init("");
+  HobotXRoc::InputParamPtr method_param(
+      new FaceSnapFilterMethodParam("filter_example",
+                                    "{\n"
+                                    " \"snap_size_thr\": 100,\n"
+                                    " \"pv_thr\": 0.5,\n"
+                                    " \"bound_thr_w\": 0,\n"
+                                    " \"bound_thr_h\": 0,\n"
+                                    " \"black_area_list\": [[0, 0, 99, 99]],\n"
+                                    " \"err_description\": {\n"
+                                    "    \"passed\": 0,\n"
+                                    "    \"snap_size_thr\": -2,\n"
+                                    "    \"pv_thr\": -5,\n"
+                                    "    \"black_list\": -8\n"
+                                    " }"
+                                    "}"));
+  std::vector<std::vector<BaseDataPtr>> input(1);
+  std::vector<HobotXRoc::InputParamPtr> param(1, method_param);
+  input[0].push_back(std::make_shared<BaseDataVector>());
+  auto face_box = std::static_pointer_cast<BaseDataVector>(input[0][0]);
+  // small faces in the black area with a low score: black list wins over
+  // face confidence, which wins over size, whatever the stage order is
+  for (int i = 0; i < 300; ++i) {
+    auto box = std::make_shared<XRocBBox>();
+    box->value.x1 = 20;
+    box->value.y1 = 20;
+    box->value.x2 = i % 3 ? 60 : 500;
+    box->value.y2 = i % 3 ? 60 : 500;
+    box->value.score = i % 2 ? 0.1 : 0.9;
+    face_box->datas_.push_back(box);
+  }
+  for (int frame = 0; frame < 3; ++frame) {
+    auto output = method.DoProcess(input, param);
+    auto err_code = std::static_pointer_cast<BaseDataVector>(output[0][0]);
+    ASSERT_EQ(err_code->datas_.size(), 300);
+    for (int i = 0; i < 300; ++i) {
+      int expected = i % 3 ? -8 : (i % 2 ? -5 : 0);
+      EXPECT_EQ(std::static_pointer_cast<XRocFilterDescription>(
+          err_code->datas_[i])->value, expected) << "face " << i;
+    }
+  }
+}
+
+TEST(FaceSnapFilterAreaIndexTest, same_as_linear_scan) {
+  srand(7);
+  BlackListsModule black_list;
+  WhiteListsModule white_list;
+  for (int i = 0; i < 40; ++i) {
+    float x = rand() % 2000 - 40, y = rand() % 1160 - 40;
+    float w = rand() % 400 + 1, h = rand() % 400 + 1;
+    black_list.AddBlackList(x, y, x + w, y + h, (rand() % 10) / 10.f);
+    white_list.AddWhiteList(x, y, x + w, y + h);
+  }
+  AreaGridIndex<BlackArea> black_index;
+  AreaGridIndex<WhiteArea> white_index;
+  black_index.Build(black_list.GetBlackAreaList(), 1920, 1080);
+  white_index.Build(white_list.GetWhiteAreaList(), 1920, 1080);
+  EXPECT_EQ(black_index.size(), 40);
+
+  for (int i = 0; i < 2000; ++i) {
+    float x1 = rand() % 2000 - 40, y1 = rand() % 1160 - 40;
+    float x2 = x1 + rand() % 300, y2 = y1 + rand() % 300;
+    bool black_expected = false;
+    for (auto &area : black_list.GetBlackAreaList()) {
+      black_expected |= black_list.IsSameBBox(x1, y1, x2, y2, area);
+    }
+    bool black_actual = black_index.AnyOverlap(
+        x1, y1, x2, y2, [&](const BlackArea &area) {
+          return black_list.IsSameBBox(x1, y1, x2, y2, area);
+        });
+    EXPECT_EQ(black_actual, black_expected);
+
+    float c_x = x1 + (x2 - x1) * 0.5;
+    float c_y = y1 + (y2 - y1) * 0.5;
+    bool white_actual = white_index.AnyAt(
+        c_x, c_y, [&](const WhiteArea &area) {
+          return WhiteListsModule::IsInZone(x1, y1, x2, y2, area);
+        });
+    EXPECT_EQ(white_actual, white_list.IsInZone(x1, y1, x2, y2));
+  }
+}
+
 }  // namespace HobotXRoc
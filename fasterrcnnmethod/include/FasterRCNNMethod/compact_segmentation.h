@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2026 Horizon Robotics. All rights reserved.
+//
+
+#ifndef INCLUDE_FASTERRCNNMETHOD_COMPACT_SEGMENTATION_H_
+#define INCLUDE_FASTERRCNNMETHOD_COMPACT_SEGMENTATION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "horizon/vision_type/vision_type.hpp"
+
+namespace faster_rcnn_method {
+
+// BaseData::type_ of XRocData<CompactSegmentation>
+#define COMPACT_SEGMENTATION_TYPE "CompactSegmentation"
+
+/**
+ * mask output used instead of hobot::vision::Segmentation when "mask_format"
+ * of net_info is uint8 or rle.
+ * uint8: values[i] = offset + data[i] * scale, row major, height * width.
+ * rle: value > threshold, run lengths in row major order starting with a
+ *      run of 0 (which may be empty), alternating 0 and 1.
+ */
+struct CompactSegmentation {
+  enum class Format { UINT8, RLE };
+
+  Format format = Format::UINT8;
+  int32_t width = 0;
+  int32_t height = 0;
+  // only for uint8
+  float scale = 0.0f;
+  float offset = 0.0f;
+  // only for rle
+  float threshold = 0.0f;
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> runs;
+  float score = 0.0f;
+
+  // decode to the float mask, rle decodes to 0/1
+  void ToSegmentation(hobot::vision::Segmentation *mask) const {
+    mask->width = width;
+    mask->height = height;
+    mask->score = score;
+    mask->values.resize(width * height);
+    if (format == Format::UINT8) {
+      for (size_t i = 0; i < data.size(); ++i) {
+        mask->values[i] = offset + data[i] * scale;
+      }
+      return;
+    }
+    size_t pos = 0;
+    float value = 0.0f;
+    for (auto run : runs) {
+      for (uint32_t i = 0; i < run && pos < mask->values.size(); ++i) {
+        mask->values[pos++] = value;
+      }
+      value = 1.0f - value;
+    }
+  }
+};
+
+}  // namespace faster_rcnn_method
+
+#endif  // INCLUDE_FASTERRCNNMETHOD_COMPACT_SEGMENTATION_H_
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2026 Horizon Robotics. All rights reserved.
+//
+
+#ifndef INCLUDE_FASTERRCNNMETHOD_DETECT_SCHEDULER_H_
+#define INCLUDE_FASTERRCNNMETHOD_DETECT_SCHEDULER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "FasterRCNNMethod/config.h"
+#include "FasterRCNNMethod/result.h"
+
+namespace faster_rcnn_method {
+
+// where to run the detector on one pyramid frame
+struct DetectWindow {
+  // run on the whole pyramid_layer as before
+  bool full_frame = true;
+  // otherwise a window of pyramid_layer at (x, y), sized to the input of
+  // the window model
+  int pyramid_layer = 0;
+  int x = 0;
+  int y = 0;
+  // layer size / source image size
+  float scale_x = 1.0f;
+  float scale_y = 1.0f;
+};
+
+/**
+ * Decides per frame whether the detector runs on the full frame, on a
+ * window around the last detections and the entry zones, or not at all.
+ * Full frame detection runs every full_detect_interval frames of a channel.
+ * In between, the window is taken from the finest roi_pyramid_layers layer
+ * that still covers every region of interest, limited so that the smallest
+ * last detection is not scaled beyond roi_target_size. Frames with nothing
+ * to look at are skipped.
+ * Windows are run by roi_model_name, a build of the detector with the
+ * smaller input roi_model_input_width x roi_model_input_height; without it
+ * they are model input sized and cost as much BPU time as a full frame.
+ */
+class DetectScheduler {
+ public:
+  void Init(const std::shared_ptr<Config> &config, int default_layer,
+            int model_input_width, int model_input_height);
+
+  bool Enabled() const { return full_detect_interval_ > 1; }
+
+  // candidate layers, roi_layer_sizes of Schedule follow this order
+  const std::vector<int> &RoiLayers() const { return roi_layers_; }
+
+  // model running the windows, empty for the full frame model
+  const std::string &RoiModelName() const { return roi_model_name_; }
+
+  // roi_layer_sizes: {width, height} of each RoiLayers() layer.
+  // return false if detection should be skipped for this frame.
+  bool Schedule(uint32_t channel_id, int src_width, int src_height,
+                const std::vector<std::pair<int, int>> &roi_layer_sizes,
+                DetectWindow *window);
+
+  // det_result boxes must be in source image coordinates
+  void Update(uint32_t channel_id, const FasterRCNNOutMsg &det_result);
+
+ private:
+  struct ChannelState {
+    uint64_t frame_cnt = 0;
+    std::vector<BBox> boxes;
+  };
+
+  int full_detect_interval_ = 1;
+  float roi_expand_ratio_ = 0.5f;
+  float roi_target_size_ = 0.0f;
+  std::vector<int> roi_layers_;
+  std::vector<BBox> entry_zones_;
+  std::string roi_model_name_;
+  // input size of the window model
+  int window_width_ = 0;
+  int window_height_ = 0;
+
+  std::unordered_map<uint32_t, ChannelState> states_;
+};
+
+}  // namespace faster_rcnn_method
+
+#endif  // INCLUDE_FASTERRCNNMETHOD_DETECT_SCHEDULER_H_
@@ -14,17 +14,22 @@
 #include <unordered_map>
 #include <atomic>
 #include <utility>
+#include "common/task_group.h"
 #include "hobotxsdk/xroc_data.h"
 #include "horizon/vision_type/vision_type.hpp"
 #include "hobotxroc/method.h"
+#include "bpu_predict/bpu_io.h"
 #include "bpu_predict/bpu_predict.h"
 #include "hbdk/hbdk_layout.h"
 #include "hbdk/hbdk_hbrt.h"
 #include "hobotxroc/method.h"
 #include "3rd_party_lib/plat_cnn.h"
 #include "result.h"
+#include "compact_segmentation.h"
+#include "detect_scheduler.h"
 #include "config.h"
 #include "hobot_vision/bpu_handle_manager.hpp"
+#include "hobot_vision/bpumodel_manager.hpp"
 
 namespace faster_rcnn_method {
 
@@ -42,6 +47,12 @@ enum class FasterRCNNBranchOutType {
   INVALID
 };
 
+enum class MaskFormat {
+  FLOAT,  // hobot::vision::Segmentation
+  UINT8,  // CompactSegmentation
+  RLE     // CompactSegmentation
+};
+
 struct FasterRCNNBranchInfo {
   FasterRCNNBranchOutType type;
   std::string name;
@@ -78,11 +89,29 @@ class FasterRCNNImp {
 
   void GetModelInfo(const std::string &model_name);
 
+  // the window model must have the same output branches as model_name_
+  void CheckRoiModel(const std::string &roi_model_name);
+
+  void BuildNativeIndex(hbrt_layout_type_t layout_type,
+                        hbrt_element_type_t element_type,
+                        const hbrt_dimension_t &aligned_dim,
+                        std::vector<uint32_t> *index);
+
   void GetFrameOutput(int src_img_width, int src_img_height,
+                      const DetectWindow &window, uint32_t channel_id,
                       std::vector<HobotXRoc::BaseDataPtr> &frame_output);
 
   void PostProcess(FasterRCNNOutMsg &det_result);
 
+  // decode the output of one branch which depends on boxes, safe to run
+  // concurrently with other branches.
+  void PostProcessBranch(const FasterRCNNBranchInfo &branch_info,
+                         BPU_Buffer_Handle output,
+                         const std::vector<hobot::vision::BBox> &boxes,
+                         BPU_Buffer_Handle lmk2_label_out_put,
+                         BPU_Buffer_Handle lmk2_offset_out_put,
+                         FasterRCNNOutMsg &result);
+
   // get face, head or body boxes.
   void GetRects(std::vector<hobot::vision::BBox> &boxes,
                 BPU_Buffer_Handle output);
@@ -99,6 +128,12 @@ class FasterRCNNImp {
   void GetMask(std::vector<hobot::vision::Segmentation> &masks,
                BPU_Buffer_Handle output,
                const std::vector<hobot::vision::BBox> &body_boxes);
+  // get body segmentation as uint8 or rle, see mask_format
+  void GetCompactMask(std::vector<CompactSegmentation> &masks,
+                      BPU_Buffer_Handle output,
+                      const std::vector<hobot::vision::BBox> &body_boxes);
+  void ConvertMask(const int32_t *mask_feature, size_t box_id,
+                   int32_t *native);
   void GetReid(std::vector<hobot::vision::Feature> &reids,
                BPU_Buffer_Handle output,
                const std::vector<hobot::vision::BBox> &body_boxes);
@@ -130,9 +165,19 @@ class FasterRCNNImp {
   std::string model_name_;
   std::string model_version_;
   int pyramid_layer_;
+  // full frame / window / skip decision for pyramid input
+  DetectScheduler detect_scheduler_;
   BPUHandle bpu_handle_;
   std::vector<BPU_Buffer_Handle> out_buf_;
+  std::shared_ptr<hobot::vision::BPUOutputBufferPool> out_buf_pool_;
   BPUModelInfo output_info_;
+  // model and output buffers of detect windows, see DetectScheduler
+  std::string roi_model_name_;
+  std::shared_ptr<hobot::vision::BPUOutputBufferPool> roi_out_buf_pool_;
+  // cv image input: fake image handle and nv12 buffer of model input size,
+  // allocated on the first cv image
+  BPUFakeImageHandle fake_img_handle_ = nullptr;
+  std::vector<uint8_t> nv12_buf_;
   std::map<int, FasterRCNNBranchInfo> out_level2rcnn_branch_info_;
   std::vector<std::string> method_outs_;
 
@@ -153,6 +198,13 @@ class FasterRCNNImp {
   int lmk_points_number_;
   int face_pose_number_;
 
+  MaskFormat mask_format_ = MaskFormat::FLOAT;
+  float mask_threshold_ = 0.5f;
+
+  // threads decoding the branches, including the calling thread
+  int post_process_thread_num_ = 1;
+  std::shared_ptr<HobotXRoc::TaskGroup> post_process_group_;
+
   int32_t plate_color_num_;
   int32_t plate_row_num_;
 
@@ -177,6 +229,9 @@ class FasterRCNNImp {
   hbrt_layout_type_t plate_color_layout_type_;
   hbrt_layout_type_t plate_row_layout_type_;
 
+  // [c][h][w] -> offset in bpu layout, see BuildNativeIndex
+  std::vector<uint32_t> kps_native_index_;
+
   hbrt_dimension_t aligned_reid_dim;
   hbrt_dimension_t aligned_mask_dim;
   hbrt_dimension_t aligned_kps_dim;
@@ -14,6 +14,7 @@
 
 #include "hobotxsdk/xroc_data.h"
 #include "horizon/vision_type/vision_type.hpp"
+#include "FasterRCNNMethod/compact_segmentation.h"
 
 namespace faster_rcnn_method {
 
@@ -29,6 +30,8 @@ struct FasterRCNNOutMsg {
   std::map<std::string, std::vector<Landmarks>> landmarks;
   std::map<std::string, std::vector<Feature>> features;
   std::map<std::string, std::vector<Segmentation>> segmentations;
+  // mask_format uint8/rle
+  std::map<std::string, std::vector<CompactSegmentation>> compact_segmentations;
   std::map<std::string, std::vector<Pose3D>> poses;
   std::map<std::string, std::vector<Attribute<int>>> attributes;
 };
@@ -46,6 +46,17 @@ inline float GetFloatByInt(int32_t value, uint32_t shift) {
   return (static_cast<float>(value)) / (static_cast<float>(1 << shift));
 }
 
+// read one int32 element of a raw bpu output
+inline int32_t GetRawInt(const int32_t *data, uint32_t offset,
+                         bool is_big_endian) {
+  int32_t value = data[offset];
+  if (is_big_endian) {
+    value = static_cast<int32_t>(
+        __builtin_bswap32(static_cast<uint32_t>(value)));
+  }
+  return value;
+}
+
 // coordinate transform.
 // fasterrcnn model's input size maybe not eqaul to origin image size,
 // needs coordinate transform for detection result.
@@ -72,6 +83,30 @@ void CoordinateTransform(FasterRCNNOutMsg &det_result,
   }
 }
 
+// detection result of a window at (window_x, window_y) of a pyramid layer
+// back to source image coordinates, scale is layer size / source size.
+void WindowCoordinateTransform(FasterRCNNOutMsg &det_result,
+                               int window_x, int window_y,
+                               float scale_x, float scale_y) {
+  for (auto &boxes : det_result.boxes) {
+    for (auto &box : boxes.second) {
+      box.x1 = (box.x1 + window_x) / scale_x;
+      box.y1 = (box.y1 + window_y) / scale_y;
+      box.x2 = (box.x2 + window_x) / scale_x;
+      box.y2 = (box.y2 + window_y) / scale_y;
+    }
+  }
+
+  for (auto &landmarks : det_result.landmarks) {
+    for (auto &landmark : landmarks.second) {
+      for (auto &point : landmark.values) {
+        point.x = (point.x + window_x) / scale_x;
+        point.y = (point.y + window_y) / scale_y;
+      }
+    }
+  }
+}
+
 std::string GetParentPath(const std::string &path) {
   auto pos = path.rfind('/');
   if (std::string::npos != pos) {
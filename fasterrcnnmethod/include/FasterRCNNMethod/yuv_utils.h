@@ -15,4 +15,12 @@ void nv12_to_bgr(uint8_t *yuv420sp, int height, int width, cv::Mat &img_bgr);
 
 void bgr_to_nv12(uint8_t *bgr, int height, int width, cv::Mat &img_nv12);
 
+// bilinear resize bgr (src_height x src_width, src_step bytes per row) to
+// dst_height x dst_width and convert to nv12 in one pass, writing
+// dst_height * dst_width * 3 / 2 bytes to nv12. dst_height and dst_width
+// must be even. Same color conversion as bgr_to_nv12 (BT.601 video range).
+void bgr_resize_to_nv12(const uint8_t *bgr, int src_height, int src_width,
+                        int src_step, int dst_height, int dst_width,
+                        uint8_t *nv12);
+
 #endif // INCLUDE_FASTERRCNNMETHOD_YUV_UTILS_H_
@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2026 Horizon Robotics. All rights reserved.
+//
+
+#include "FasterRCNNMethod/detect_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "hobotlog/hobotlog.hpp"
+
+namespace faster_rcnn_method {
+
+void DetectScheduler::Init(const std::shared_ptr<Config> &config,
+                           int default_layer, int model_input_width,
+                           int model_input_height) {
+  window_width_ = model_input_width;
+  window_height_ = model_input_height;
+  roi_layers_ = {default_layer};
+  if (!config) {
+    return;
+  }
+  full_detect_interval_ = config->GetIntValue("full_detect_interval", 1);
+  roi_model_name_ = config->GetSTDStringValue("roi_model_name");
+  if (!roi_model_name_.empty()) {
+    window_width_ = config->GetIntValue("roi_model_input_width");
+    window_height_ = config->GetIntValue("roi_model_input_height");
+    HOBOT_CHECK(window_width_ > 0 && window_width_ <= model_input_width &&
+                window_height_ > 0 && window_height_ <= model_input_height)
+        << "roi model input must not exceed the model input";
+  }
+  roi_expand_ratio_ = config->GetFloatValue("roi_expand_ratio", 0.5);
+  roi_target_size_ = config->GetFloatValue("roi_target_size", 0);
+  auto layers = config->GetIntArray("roi_pyramid_layers");
+  if (!layers.empty()) {
+    roi_layers_ = layers;
+  }
+  for (auto &zone : config->GetSubConfigArray("entry_zones")) {
+    BBox box;
+    box.x1 = zone->GetFloatValue("x1");
+    box.y1 = zone->GetFloatValue("y1");
+    box.x2 = zone->GetFloatValue("x2");
+    box.y2 = zone->GetFloatValue("y2");
+    HOBOT_CHECK(box.x2 > box.x1 && box.y2 > box.y1) << "invalid entry zone";
+    entry_zones_.push_back(box);
+  }
+  LOGI << "detect schedule, full_detect_interval: " << full_detect_interval_
+       << ", roi_expand_ratio: " << roi_expand_ratio_
+       << ", roi_target_size: " << roi_target_size_
+       << ", entry zone num: " << entry_zones_.size()
+       << ", roi model: " << roi_model_name_ << " " << window_width_ << "x"
+       << window_height_;
+  if (Enabled() && roi_model_name_.empty()) {
+    LOGW << "no roi_model_name, a window costs as much BPU time as a full "
+            "frame, only skipped frames save BPU time";
+  }
+}
+
+bool DetectScheduler::Schedule(
+    uint32_t channel_id, int src_width, int src_height,
+    const std::vector<std::pair<int, int>> &roi_layer_sizes,
+    DetectWindow *window) {
+  HOBOT_CHECK(roi_layer_sizes.size() == roi_layers_.size());
+  auto &state = states_[channel_id];
+  window->full_frame = true;
+  if (!Enabled() || state.frame_cnt++ % full_detect_interval_ == 0) {
+    return true;
+  }
+
+  // regions of interest in source image coordinates
+  float x1 = std::numeric_limits<float>::max();
+  float y1 = std::numeric_limits<float>::max();
+  float x2 = std::numeric_limits<float>::lowest();
+  float y2 = std::numeric_limits<float>::lowest();
+  float min_size = std::numeric_limits<float>::max();
+  for (const auto &box : state.boxes) {
+    float expand_w = box.Width() * roi_expand_ratio_;
+    float expand_h = box.Height() * roi_expand_ratio_;
+    x1 = std::min(x1, box.x1 - expand_w);
+    y1 = std::min(y1, box.y1 - expand_h);
+    x2 = std::max(x2, box.x2 + expand_w);
+    y2 = std::max(y2, box.y2 + expand_h);
+    min_size = std::min(min_size, std::min(box.Width(), box.Height()));
+  }
+  for (const auto &zone : entry_zones_) {
+    x1 = std::min(x1, zone.x1);
+    y1 = std::min(y1, zone.y1);
+    x2 = std::max(x2, zone.x2);
+    y2 = std::max(y2, zone.y2);
+  }
+  x1 = std::max(x1, 0.0f);
+  y1 = std::max(y1, 0.0f);
+  x2 = std::min(x2, static_cast<float>(src_width));
+  y2 = std::min(y2, static_cast<float>(src_height));
+  if (x2 <= x1 || y2 <= y1) {
+    return false;
+  }
+
+  // largest scale covering the region and not above the wanted scale,
+  // otherwise the smallest scale covering the region
+  float wanted_scale = std::numeric_limits<float>::max();
+  if (roi_target_size_ > 0 && min_size > 0 && !state.boxes.empty()) {
+    wanted_scale = roi_target_size_ / min_size;
+  }
+  int best = -1;
+  float best_scale = 0;
+  for (size_t i = 0; i < roi_layers_.size(); ++i) {
+    int layer_width = roi_layer_sizes[i].first;
+    int layer_height = roi_layer_sizes[i].second;
+    if (layer_width < window_width_ ||
+        layer_height < window_height_) {
+      continue;
+    }
+    float scale = static_cast<float>(layer_width) / src_width;
+    float scale_y = static_cast<float>(layer_height) / src_height;
+    if ((x2 - x1) * scale > window_width_ ||
+        (y2 - y1) * scale_y > window_height_) {
+      continue;
+    }
+    bool better;
+    if (best < 0) {
+      better = true;
+    } else if (scale <= wanted_scale) {
+      better = best_scale > wanted_scale || scale > best_scale;
+    } else {
+      better = best_scale > wanted_scale && scale < best_scale;
+    }
+    if (better) {
+      best = i;
+      best_scale = scale;
+    }
+  }
+  if (best < 0) {
+    // nothing covers the region, detect on the full frame
+    return true;
+  }
+
+  int layer_width = roi_layer_sizes[best].first;
+  int layer_height = roi_layer_sizes[best].second;
+  window->full_frame = false;
+  window->pyramid_layer = roi_layers_[best];
+  window->scale_x = static_cast<float>(layer_width) / src_width;
+  window->scale_y = static_cast<float>(layer_height) / src_height;
+  // center the window on the region, keep it inside the layer
+  float center_x = (x1 + x2) / 2 * window->scale_x;
+  float center_y = (y1 + y2) / 2 * window->scale_y;
+  int x = static_cast<int>(center_x) - window_width_ / 2;
+  int y = static_cast<int>(center_y) - window_height_ / 2;
+  x = std::min(std::max(x, 0), layer_width - window_width_);
+  y = std::min(std::max(y, 0), layer_height - window_height_);
+  // nv12 crop start must be even
+  window->x = x & ~1;
+  window->y = y & ~1;
+  return true;
+}
+
+void DetectScheduler::Update(uint32_t channel_id,
+                             const FasterRCNNOutMsg &det_result) {
+  auto &boxes = states_[channel_id].boxes;
+  boxes.clear();
+  for (const auto &named_boxes : det_result.boxes) {
+    boxes.insert(boxes.end(), named_boxes.second.begin(),
+                 named_boxes.second.end());
+  }
+}
+
+}  // namespace faster_rcnn_method
@@ -179,9 +179,16 @@ void DumpMask(cv::Mat &frame, const std::shared_ptr<BaseDataVector> &masks,
     int x2 = body_box.x2;
     int y2 = body_box.y2;
 
-    auto xroc_mask =
-        std::static_pointer_cast<XRocData<Segmentation>>((masks->datas_)[i]);
-    auto mask = xroc_mask->value;
+    Segmentation mask;
+    if ((masks->datas_)[i]->type_ == COMPACT_SEGMENTATION_TYPE) {
+      auto xroc_mask = std::static_pointer_cast<XRocData<CompactSegmentation>>(
+          (masks->datas_)[i]);
+      xroc_mask->value.ToSegmentation(&mask);
+    } else {
+      auto xroc_mask =
+          std::static_pointer_cast<XRocData<Segmentation>>((masks->datas_)[i]);
+      mask = xroc_mask->value;
+    }
     //    ofs << "(";
     //    for (const auto &value : mask.values) {
     //      ofs << value << ",";
@@ -7,6 +7,8 @@
 #include <stdint.h>
 #include <algorithm>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -35,6 +37,9 @@
 #include "FasterRCNNMethod/util.h"
 #include "FasterRCNNMethod/yuv_utils.h"
 #include "common/common.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 
 #define DMA_ALIGN_SIZE 64
 #define BPU_CEIL_ALIGN(len) \
@@ -74,27 +79,22 @@ static std::map<std::string, FasterRCNNBranchOutType> str2faster_rcnn_out_type =
      {"plate_row", FasterRCNNBranchOutType::PLATE_ROW}};
 
 
+// check out output buffers from the model's pool, give back on destroy.
 class ModelOutputBuffer {
  public:
-  ModelOutputBuffer(const BPUModelInfo &output_info,
-                    std::vector<BPU_Buffer_Handle> &output_buf)
-      : output_buf_(output_buf) {
-    // alloc output buffer.
-    for (int i = 0; i < output_info.num; ++i) {
-      BPU_Buffer_Handle out_handle = BPU_createEmptyBPUBuffer();
-      output_buf_.push_back(out_handle);
-    }
-    LOGD << "create bpu buffer success.";
+  ModelOutputBuffer(
+      const std::shared_ptr<hobot::vision::BPUOutputBufferPool> &pool,
+      std::vector<BPU_Buffer_Handle> &output_buf)
+      : pool_(pool), output_buf_(output_buf) {
+    pool_->Get(1, &output_buf_);
+    LOGD << "get bpu buffer success.";
   }
   ~ModelOutputBuffer() {
-    // release output buffer.
-    for (auto &buf : output_buf_) {
-      BPU_freeBPUBuffer(buf);
-    }
-    output_buf_.clear();
-    LOGD << "release bpu buffer success.";
+    pool_->Put(&output_buf_);
+    LOGD << "put back bpu buffer success.";
   }
  private:
+  std::shared_ptr<hobot::vision::BPUOutputBufferPool> pool_;
   std::vector<BPU_Buffer_Handle> &output_buf_;
 };
 
@@ -146,6 +146,28 @@ void FasterRCNNImp::ParseConfig(const std::string &config_file) {
   plate_color_num_ = net_info->GetIntValue("plate_color_num", 6);
   plate_row_num_ = net_info->GetIntValue("plate_row_num", 2);
 
+  std::string mask_format = net_info->GetSTDStringValue("mask_format",
+                                                        "float");
+  if (mask_format == "float") {
+    mask_format_ = MaskFormat::FLOAT;
+  } else if (mask_format == "uint8") {
+    mask_format_ = MaskFormat::UINT8;
+  } else if (mask_format == "rle") {
+    mask_format_ = MaskFormat::RLE;
+  } else {
+    HOBOT_CHECK(0) << "Not support mask_format: " << mask_format;
+  }
+  mask_threshold_ = net_info->GetFloatValue("mask_threshold", 0.5);
+
+  post_process_thread_num_ =
+      config_->GetIntValue("post_process_thread_num", 1);
+
+  detect_scheduler_.Init(config_->GetSubConfig("detect_schedule"),
+                         pyramid_layer_, model_input_width_,
+                         model_input_height_);
+  HOBOT_CHECK(post_process_thread_num_ >= 1)
+      << "post_process_thread_num must be at least 1";
+
   method_outs_ = config_->GetSTDStringArray("method_outs");
   LOGD << "method out type:";
   for (const auto &method_out : method_outs_) {
@@ -162,6 +184,53 @@ void FasterRCNNImp::ParseConfig(const std::string &config_file) {
        << " model_file_path: " << model_file_path_;
 }
 
+// values[i] = data[i] / 2^shift
+static void DequantizeInt(const int32_t *data, int num, uint32_t shift,
+                          float *values) {
+  const float scale = GetFloatByInt(1, shift);
+  int i = 0;
+#ifdef __ARM_NEON
+  for (; i + 4 <= num; i += 4) {
+    float32x4_t v = vcvtq_f32_s32(vld1q_s32(data + i));
+    vst1q_f32(values + i, vmulq_n_f32(v, scale));
+  }
+#endif
+  for (; i < num; ++i) {
+    values[i] = data[i] * scale;
+  }
+}
+
+// map every element of one roi's output, in native [c][h][w] order, to its
+// offset in the bpu layout. Built once by converting a buffer holding each
+// element's own offset, so decoders can read single elements of the raw
+// output instead of converting whole channels per frame.
+void FasterRCNNImp::BuildNativeIndex(hbrt_layout_type_t layout_type,
+                                     hbrt_element_type_t element_type,
+                                     const hbrt_dimension_t &aligned_dim,
+                                     std::vector<uint32_t> *index) {
+  HOBOT_CHECK(element_type == ELEMENT_TYPE_INT32 ||
+              element_type == ELEMENT_TYPE_UINT32)
+      << "only 32bit output supports native index, element type: "
+      << element_type;
+  int hw = aligned_dim.h * aligned_dim.w;
+  int c = aligned_dim.c;
+  std::vector<uint32_t> raw_offset(hw * c);
+  for (size_t i = 0; i < raw_offset.size(); ++i) {
+    raw_offset[i] = i;
+  }
+  // NHWC native, endianness kept so offsets are not swapped
+  std::vector<uint32_t> nhwc_offset(hw * c);
+  CHECK_HBRT_ERROR(hbrtConvertLayout(nhwc_offset.data(), LAYOUT_NHWC_NATIVE,
+                                     raw_offset.data(), layout_type,
+                                     element_type, aligned_dim, false));
+  index->resize(hw * c);
+  for (int pos = 0; pos < hw; ++pos) {
+    for (int ci = 0; ci < c; ++ci) {
+      (*index)[ci * hw + pos] = nhwc_offset[pos * c + ci];
+    }
+  }
+}
+
 void FasterRCNNImp::GetModelInfo(const std::string &model_name) {
   const hbrt_feature_handle_t *feature_info;
   uint32_t output_layer_num = 0;
@@ -202,6 +271,9 @@ void FasterRCNNImp::GetModelInfo(const std::string &model_name) {
         aligned_kps_dim.n = 1;
         kps_is_big_endian = is_big_endian;
         kps_element_type = element_type;
+        HOBOT_CHECK(kps_points_number_ * 3 <= aligned_kps_dim.c);
+        BuildNativeIndex(kps_layout_type_, kps_element_type, aligned_kps_dim,
+                         &kps_native_index_);
         break;
       case FasterRCNNBranchOutType::MASK:
         mask_shift_ = shift_value[0];
@@ -275,6 +347,56 @@ void FasterRCNNImp::GetModelInfo(const std::string &model_name) {
   }
 }
 
+void FasterRCNNImp::CheckRoiModel(const std::string &roi_model_name) {
+  hbrt_hbm_handle_t hbm_handle;
+  int ret = BPU_getHBMhandleFromBPUhandle(bpu_handle_, &hbm_handle.handle);
+  HOBOT_CHECK(ret == 0) << "Load bpu model failed: "
+                        << BPU_getLastError(bpu_handle_);
+  hbrt_model_handle_t model_handle, roi_model_handle;
+  CHECK_HBRT_ERROR(hbrtGetModelHandle(&model_handle, hbm_handle,
+                                      model_name_.c_str()));
+  CHECK_HBRT_ERROR(hbrtGetModelHandle(&roi_model_handle, hbm_handle,
+                                      roi_model_name.c_str()));
+  uint32_t output_layer_num = 0, roi_output_layer_num = 0;
+  CHECK_HBRT_ERROR(hbrtGetOutputFeatureNumber(&output_layer_num,
+                                              model_handle));
+  CHECK_HBRT_ERROR(hbrtGetOutputFeatureNumber(&roi_output_layer_num,
+                                              roi_model_handle));
+  HOBOT_CHECK(output_layer_num == roi_output_layer_num)
+      << "roi model " << roi_model_name << " has " << roi_output_layer_num
+      << " outputs, model " << model_name_ << " has " << output_layer_num;
+  const hbrt_feature_handle_t *feature_info, *roi_feature_info;
+  CHECK_HBRT_ERROR(hbrtGetOutputFeatureHandles(&feature_info, model_handle));
+  CHECK_HBRT_ERROR(hbrtGetOutputFeatureHandles(&roi_feature_info,
+                                               roi_model_handle));
+  // the branches are decoded with the parameters of model_name_, the
+  // roi count (n) may differ
+  for (uint32_t i = 0; i < output_layer_num; ++i) {
+    const uint8_t *shift, *roi_shift;
+    CHECK_HBRT_ERROR(hbrtGetFeatureShiftValues(&shift, feature_info[i]));
+    CHECK_HBRT_ERROR(hbrtGetFeatureShiftValues(&roi_shift,
+                                               roi_feature_info[i]));
+    hbrt_layout_type_t layout, roi_layout;
+    CHECK_HBRT_ERROR(hbrtGetFeatureLayoutType(&layout, feature_info[i]));
+    CHECK_HBRT_ERROR(hbrtGetFeatureLayoutType(&roi_layout,
+                                              roi_feature_info[i]));
+    hbrt_dimension_t dim, roi_dim;
+    CHECK_HBRT_ERROR(hbrtGetFeatureAlignedDimension(&dim, feature_info[i]));
+    CHECK_HBRT_ERROR(hbrtGetFeatureAlignedDimension(&roi_dim,
+                                                    roi_feature_info[i]));
+    hbrt_element_type_t element_type, roi_element_type;
+    CHECK_HBRT_ERROR(hbrtGetFeatureElementType(&element_type,
+                                               feature_info[i]));
+    CHECK_HBRT_ERROR(hbrtGetFeatureElementType(&roi_element_type,
+                                               roi_feature_info[i]));
+    HOBOT_CHECK(shift[0] == roi_shift[0] && layout == roi_layout &&
+                element_type == roi_element_type && dim.h == roi_dim.h &&
+                dim.w == roi_dim.w && dim.c == roi_dim.c)
+        << "output " << i << " of roi model " << roi_model_name
+        << " differs from model " << model_name_;
+  }
+}
+
 int FasterRCNNImp::Init(const std::string &config_file) {
   faster_rcnn_param_ = nullptr;
   // parse config file.
@@ -288,7 +410,29 @@ int FasterRCNNImp::Init(const std::string &config_file) {
                         << " output info failed: "
                         << BPU_getLastError(bpu_handle_);
   LOGD << "BPU_getModelOutputInfo success.";
+  out_buf_pool_ = hobot::vision::BPUModelManager::Get().GetOutputBufferPool(
+      model_file_path_, model_name_, output_info_.num);
   GetModelInfo(model_name_);
+  roi_model_name_ = model_name_;
+  roi_out_buf_pool_ = out_buf_pool_;
+  if (detect_scheduler_.Enabled() &&
+      !detect_scheduler_.RoiModelName().empty()) {
+    roi_model_name_ = detect_scheduler_.RoiModelName();
+    BPUModelInfo roi_output_info;
+    ret = BPU_getModelOutputInfo(bpu_handle_, roi_model_name_.c_str(),
+                                 &roi_output_info);
+    HOBOT_CHECK(ret == 0) << "Get model " << roi_model_name_
+                          << " output info failed: "
+                          << BPU_getLastError(bpu_handle_);
+    CheckRoiModel(roi_model_name_);
+    roi_out_buf_pool_ =
+        hobot::vision::BPUModelManager::Get().GetOutputBufferPool(
+            model_file_path_, roi_model_name_, roi_output_info.num);
+  }
+  if (post_process_thread_num_ > 1) {
+    post_process_group_ =
+        std::make_shared<HobotXRoc::TaskGroup>(post_process_thread_num_);
+  }
   return 0;
 }
 
@@ -312,8 +456,30 @@ void FasterRCNNImp::RunSingleFrame(const std::vector<BaseDataPtr> &frame_input,
 
   int src_img_width = 0;
   int src_img_height = 0;
+  DetectWindow window;
+  if (img_type == kPyramidImage && detect_scheduler_.Enabled()) {
+    auto pyramid_image =
+        std::static_pointer_cast<PymImageFrame>(xroc_img->value);
+    const auto &layers = detect_scheduler_.RoiLayers();
+    std::vector<std::pair<int, int>> layer_sizes(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+      HOBOT_CHECK(layers[i] >= 0 && layers[i] < DOWN_SCALE_MAX);
+      const auto &layer = pyramid_image->img.down_scale[layers[i]];
+      layer_sizes[i] = std::make_pair(layer.width, layer.height);
+    }
+    if (!detect_scheduler_.Schedule(pyramid_image->channel_id,
+                                    pyramid_image->img.src_img.width,
+                                    pyramid_image->img.src_img.height,
+                                    layer_sizes, &window)) {
+      LOGD << "nothing to detect, skip frame";
+      detect_scheduler_.Update(pyramid_image->channel_id, FasterRCNNOutMsg());
+      return;
+    }
+  }
 
-  ModelOutputBuffer output_buf(output_info_, out_buf_);
+  // a window runs the roi model, whose outputs come from its own pool
+  ModelOutputBuffer output_buf(
+      window.full_frame ? out_buf_pool_ : roi_out_buf_pool_, out_buf_);
   {
     RUN_PROCESS_TIME_PROFILER("FasterRCNN RunModelFromPyramid");
     RUN_FPS_PROFILER("FasterRCNN RunModelFromPyramid");
@@ -323,10 +489,20 @@ void FasterRCNNImp::RunSingleFrame(const std::vector<BaseDataPtr> &frame_input,
           std::static_pointer_cast<PymImageFrame>(xroc_img->value);
       src_img_height = pyramid_image->img.src_img.height;
       src_img_width = pyramid_image->img.src_img.width;
-      ret = BPU_runModelFromPyramid(bpu_handle_, model_name_.c_str(),
-                                    static_cast<void *>(&(pyramid_image->img)),
-                                    pyramid_layer_, out_buf_.data(),
-                                    out_buf_.size(), &model_handle);
+      if (window.full_frame) {
+        ret = BPU_runModelFromPyramid(
+            bpu_handle_, model_name_.c_str(),
+            static_cast<void *>(&(pyramid_image->img)), pyramid_layer_,
+            out_buf_.data(), out_buf_.size(), &model_handle);
+      } else {
+        LOGD << "detect window, layer: " << window.pyramid_layer
+             << ", x: " << window.x << ", y: " << window.y;
+        ret = BPU_runModelCropPyramid(
+            bpu_handle_, roi_model_name_.c_str(),
+            static_cast<void *>(&(pyramid_image->img)), window.pyramid_layer,
+            window.x, window.y, out_buf_.data(), out_buf_.size(),
+            &model_handle);
+      }
 
     } else if (img_type == kCVImageFrame) {
       auto cv_image = std::static_pointer_cast<CVImageFrame>(xroc_img->value);
@@ -337,40 +513,38 @@ void FasterRCNNImp::RunSingleFrame(const std::vector<BaseDataPtr> &frame_input,
       src_img_height = cv_image->Height();
       src_img_width = cv_image->Width();
 
-      auto img_mat = cv_image->img;
-      cv::Mat resized_mat = img_mat;
-      if (src_img_height != model_input_height_ &&
-          src_img_width != model_input_width_) {
-        LOGD << "need resize.";
-        cv::resize(img_mat, resized_mat,
-                   cv::Size(model_input_width_, model_input_height_));
+      if (!fake_img_handle_) {
+        // created on the first cv image and reused for every frame, pyramid
+        // input never needs them
+        HOBOT_CHECK(model_input_height_ % 2 == 0
+                    && model_input_width_ % 2 == 0)
+            << "model input size must be even for nv12";
+        ret = BPU_createFakeImageHandle(model_input_height_,
+                                        model_input_width_,
+                                        &fake_img_handle_);
+        HOBOT_CHECK(ret == 0) << "create fake image handle failed";
+        nv12_buf_.resize(model_input_width_ * model_input_height_ * 3 / 2);
       }
 
-      cv::Mat img_nv12;
-      uint8_t *bgr_data = resized_mat.ptr<uint8_t>();
-      bgr_to_nv12(bgr_data, model_input_height_, model_input_width_, img_nv12);
-      uint8_t *nv12_data = img_nv12.ptr<uint8_t>();
-
-      // construct BPUFakeImage
-      BPUFakeImageHandle fake_img_handle;
+      // resize and convert to nv12 in one pass, into the reused buffer
+      const cv::Mat &img_mat = cv_image->img;
+      bgr_resize_to_nv12(img_mat.ptr<uint8_t>(), src_img_height,
+                         src_img_width, static_cast<int>(img_mat.step),
+                         model_input_height_, model_input_width_,
+                         nv12_buf_.data());
 
-      int img_len = model_input_width_ * model_input_height_ * 3 / 2;
+      int img_len = static_cast<int>(nv12_buf_.size());
       LOGD << "nv12 img_len: " << img_len;
 
-      ret = BPU_createFakeImageHandle(model_input_height_, model_input_width_,
-                                      &fake_img_handle);
-      HOBOT_CHECK(ret == 0) << "create fake image handle failed";
-
       BPUFakeImage *fake_img_ptr = nullptr;
-      fake_img_ptr = BPU_getFakeImage(fake_img_handle, nv12_data, img_len);
+      fake_img_ptr = BPU_getFakeImage(fake_img_handle_, nv12_buf_.data(),
+                                      img_len);
       HOBOT_CHECK(fake_img_ptr != nullptr) << "get fake image failed";
       ret = BPU_runModelFromImage(bpu_handle_, model_name_.c_str(),
                                   fake_img_ptr, out_buf_.data(),
                                   out_buf_.size(), &model_handle);
 
-      BPU_releaseFakeImage(fake_img_handle, fake_img_ptr);
-
-      BPU_releaseFakeImageHandle(fake_img_handle);
+      BPU_releaseFakeImage(fake_img_handle_, fake_img_ptr);
 
     } else {
       HOBOT_CHECK(0) << "Not support this input type: " << img_type;
@@ -394,15 +568,26 @@ void FasterRCNNImp::RunSingleFrame(const std::vector<BaseDataPtr> &frame_input,
   RUN_FPS_PROFILER("FasterRCNN PostProcess");
 
   // Post process
-  GetFrameOutput(src_img_width, src_img_height, frame_output);
+  GetFrameOutput(src_img_width, src_img_height, window,
+                 xroc_img->value->channel_id, frame_output);
 }
 
 void FasterRCNNImp::GetFrameOutput(int src_img_width, int src_img_height,
+                                   const DetectWindow &window,
+                                   uint32_t channel_id,
                                    std::vector<BaseDataPtr> &frame_output) {
   FasterRCNNOutMsg det_result;
   PostProcess(det_result);
-  CoordinateTransform(det_result, src_img_width, src_img_height,
-                      model_input_width_, model_input_height_);
+  if (window.full_frame) {
+    CoordinateTransform(det_result, src_img_width, src_img_height,
+                        model_input_width_, model_input_height_);
+  } else {
+    WindowCoordinateTransform(det_result, window.x, window.y,
+                              window.scale_x, window.scale_y);
+  }
+  if (detect_scheduler_.Enabled()) {
+    detect_scheduler_.Update(channel_id, det_result);
+  }
   for (auto &boxes : det_result.boxes) {
     LOGD << boxes.first << ", num: " << boxes.second.size();
     for (auto &box : boxes.second) {
@@ -500,6 +685,21 @@ void FasterRCNNImp::GetFrameOutput(int src_img_width, int src_img_height,
     }
   }
 
+  for (auto &segmentation_vec : det_result.compact_segmentations) {
+    xroc_det_result[segmentation_vec.first] =
+        std::make_shared<HobotXRoc::BaseDataVector>();
+    xroc_det_result[segmentation_vec.first]->name_ =
+        "rcnn_" + segmentation_vec.first;
+    for (auto &segmentation : segmentation_vec.second) {
+      auto xroc_segmentation =
+          std::make_shared<XRocData<CompactSegmentation>>();
+      xroc_segmentation->type_ = COMPACT_SEGMENTATION_TYPE;
+      xroc_segmentation->value = std::move(segmentation);
+      xroc_det_result[segmentation_vec.first]->datas_.push_back(
+          xroc_segmentation);
+    }
+  }
+
   // poses
   for (const auto &pose_vec : det_result.poses) {
     xroc_det_result[pose_vec.first] =
@@ -531,6 +731,20 @@ void FasterRCNNImp::GetFrameOutput(int src_img_width, int src_img_height,
   }
 }
 
+template <typename T>
+static void MergeResult(std::map<std::string, std::vector<T>> *from,
+                        std::map<std::string, std::vector<T>> *to) {
+  for (auto &result : *from) {
+    auto &dst = (*to)[result.first];
+    if (dst.empty()) {
+      dst = std::move(result.second);
+    } else {
+      std::move(result.second.begin(), result.second.end(),
+                std::back_inserter(dst));
+    }
+  }
+}
+
 void FasterRCNNImp::PostProcess(FasterRCNNOutMsg &det_result) {
   BPU_Buffer_Handle lmk2_label_out_put = nullptr;
   BPU_Buffer_Handle lmk2_offset_out_put = nullptr;
@@ -555,50 +769,98 @@ void FasterRCNNImp::PostProcess(FasterRCNNOutMsg &det_result) {
     }
   }
 
+  // branches only depend on the boxes from here on. Each one decodes into
+  // its own result, merged in output order afterwards, so the result does
+  // not depend on post_process_thread_num.
+  // the branch infos and boxes are looked up here, the tasks never touch
+  // the maps
+  std::vector<size_t> branch_levels;
+  std::vector<const FasterRCNNBranchInfo *> branch_infos;
+  std::vector<const std::vector<BBox> *> branch_boxes;
   for (size_t out_level = 0; out_level < out_buf_.size(); ++out_level) {
     const auto &branch_info = out_level2rcnn_branch_info_[out_level];
-    auto out_type = branch_info.type;
-    switch (out_type) {
+    switch (branch_info.type) {
       case FasterRCNNBranchOutType::INVALID:
-        break;
-      case FasterRCNNBranchOutType::KPS:
-        GetKps(det_result.landmarks[branch_info.name], out_buf_[out_level],
-               det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::MASK:
-        GetMask(det_result.segmentations[branch_info.name], out_buf_[out_level],
-                det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::REID:
-        GetReid(det_result.features[branch_info.name], out_buf_[out_level],
-                det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::LMKS2_LABEL:
-        GetLMKS2(det_result.landmarks["landmark2"], lmk2_label_out_put,
-                 lmk2_offset_out_put, det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::LMKS1:
-        GetLMKS1(det_result.landmarks["landmark1"], out_buf_[out_level],
-                 det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::POSE_3D:
-        GetPose(det_result.poses[branch_info.name], out_buf_[out_level],
-                det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::PLATE_COLOR:
-        GetPlateColor(&(det_result.attributes[branch_info.name]),
-                      out_buf_[out_level],
-                      det_result.boxes[branch_info.box_name]);
-        break;
-      case FasterRCNNBranchOutType::PLATE_ROW:
-        GetPlateRow(&(det_result.attributes[branch_info.name]),
-                    out_buf_[out_level],
-                    det_result.boxes[branch_info.box_name]);
+      case FasterRCNNBranchOutType::BBOX:
+      case FasterRCNNBranchOutType::LMKS2_OFFSET:
         break;
       default:
+        branch_levels.push_back(out_level);
+        branch_infos.push_back(&branch_info);
+        branch_boxes.push_back(&det_result.boxes[branch_info.box_name]);
         break;
     }
   }
+
+  std::vector<FasterRCNNOutMsg> branch_results(branch_levels.size());
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(branch_levels.size());
+  for (size_t i = 0; i < branch_levels.size(); ++i) {
+    tasks.emplace_back([&, i] {
+      PostProcessBranch(*branch_infos[i], out_buf_[branch_levels[i]],
+                        *branch_boxes[i], lmk2_label_out_put,
+                        lmk2_offset_out_put, branch_results[i]);
+    });
+  }
+  if (post_process_group_) {
+    post_process_group_->Run(tasks);
+  } else {
+    for (auto &task : tasks) {
+      task();
+    }
+  }
+
+  for (auto &branch_result : branch_results) {
+    MergeResult(&branch_result.landmarks, &det_result.landmarks);
+    MergeResult(&branch_result.features, &det_result.features);
+    MergeResult(&branch_result.segmentations, &det_result.segmentations);
+    MergeResult(&branch_result.compact_segmentations,
+                &det_result.compact_segmentations);
+    MergeResult(&branch_result.poses, &det_result.poses);
+    MergeResult(&branch_result.attributes, &det_result.attributes);
+  }
+}
+
+void FasterRCNNImp::PostProcessBranch(const FasterRCNNBranchInfo &branch_info,
+                                      BPU_Buffer_Handle output,
+                                      const std::vector<BBox> &boxes,
+                                      BPU_Buffer_Handle lmk2_label_out_put,
+                                      BPU_Buffer_Handle lmk2_offset_out_put,
+                                      FasterRCNNOutMsg &result) {
+  switch (branch_info.type) {
+    case FasterRCNNBranchOutType::KPS:
+      GetKps(result.landmarks[branch_info.name], output, boxes);
+      break;
+    case FasterRCNNBranchOutType::MASK:
+      if (mask_format_ == MaskFormat::FLOAT) {
+        GetMask(result.segmentations[branch_info.name], output, boxes);
+      } else {
+        GetCompactMask(result.compact_segmentations[branch_info.name],
+                       output, boxes);
+      }
+      break;
+    case FasterRCNNBranchOutType::REID:
+      GetReid(result.features[branch_info.name], output, boxes);
+      break;
+    case FasterRCNNBranchOutType::LMKS2_LABEL:
+      GetLMKS2(result.landmarks["landmark2"], lmk2_label_out_put,
+               lmk2_offset_out_put, boxes);
+      break;
+    case FasterRCNNBranchOutType::LMKS1:
+      GetLMKS1(result.landmarks["landmark1"], output, boxes);
+      break;
+    case FasterRCNNBranchOutType::POSE_3D:
+      GetPose(result.poses[branch_info.name], output, boxes);
+      break;
+    case FasterRCNNBranchOutType::PLATE_COLOR:
+      GetPlateColor(&(result.attributes[branch_info.name]), output, boxes);
+      break;
+    case FasterRCNNBranchOutType::PLATE_ROW:
+      GetPlateRow(&(result.attributes[branch_info.name]), output, boxes);
+      break;
+    default:
+      break;
+  }
 }
 
 void FasterRCNNImp::GetRects(std::vector<BBox> &boxes,
@@ -661,11 +923,15 @@ void FasterRCNNImp::GetKps(std::vector<Landmarks> &kpss,
   size_t body_box_num = body_boxes.size();
   int feature_size =
       aligned_kps_dim.h * aligned_kps_dim.w * aligned_kps_dim.c;
+  // kps_native_index_ is channel major: [c][h][w] -> raw offset
+  int channel_size = aligned_kps_dim.h * aligned_kps_dim.w;
+  int row_stride = aligned_kps_dim.w;
+  const uint32_t *index = kps_native_index_.data();
 
-  std::vector<int32_t> mxnet_out_for_one_point(
-      kps_feat_height_ * kps_feat_width_, 0);
+  kpss.reserve(kpss.size() + body_box_num);
   for (size_t box_id = 0; box_id < body_box_num; ++box_id) {
     const auto &body_box = body_boxes[box_id];
+    const int32_t *box_feature = kps_feature + feature_size * box_id;
     float x1 = body_box.x1;
     float y1 = body_box.y1;
     float x2 = body_box.x2;
@@ -680,46 +946,35 @@ void FasterRCNNImp::GetKps(std::vector<Landmarks> &kpss,
     skeleton.values.resize(kps_points_number_);
 
     for (int kps_id = 0; kps_id < kps_points_number_; ++kps_id) {
-      mxnet_out_for_one_point.assign(kps_feat_height_ * kps_feat_width_, 0);
-      unsigned best_index = 0;
-      CHECK_HBRT_ERROR(hbrtConvertLayoutToNative1HW1(
-                                              mxnet_out_for_one_point.data(),
-                                         kps_feature + feature_size * box_id,
-                                          kps_layout_type_, kps_element_type,
-                                              aligned_kps_dim,
-                                              kps_is_big_endian, 0, kps_id));
-
-      // find the best position
-      for (int i = 0; i < kps_feat_width_ * kps_feat_height_; ++i) {
-        if (mxnet_out_for_one_point[i] > mxnet_out_for_one_point[best_index]) {
-          best_index = i;
+      // find the best position directly in the bpu layout
+      const uint32_t *heatmap = index + kps_id * channel_size;
+      int32_t max_value =
+          GetRawInt(box_feature, heatmap[0], kps_is_big_endian);
+      unsigned max_w = 0;
+      unsigned max_h = 0;
+      for (int hi = 0; hi < kps_feat_height_; ++hi) {
+        const uint32_t *row = heatmap + hi * row_stride;
+        for (int wi = 0; wi < kps_feat_width_; ++wi) {
+          int32_t value = GetRawInt(box_feature, row[wi], kps_is_big_endian);
+          if (value > max_value) {
+            max_value = value;
+            max_h = hi;
+            max_w = wi;
+          }
         }
       }
-      float max_score =
-          GetFloatByInt(mxnet_out_for_one_point[best_index], kps_shift_);
-      // best_index = max_h * kps_feat_width + max_w
-      unsigned max_w = best_index % kps_feat_width_;
-      unsigned max_h = best_index / kps_feat_width_;
-
-      // get delta
-      mxnet_out_for_one_point.assign(kps_feat_width_ * kps_feat_height_, 0);
-      CHECK_HBRT_ERROR(hbrtConvertLayoutToNative1HW1(
-                                        mxnet_out_for_one_point.data(),
-                                        kps_feature + feature_size * box_id,
-                                        kps_layout_type_, kps_element_type,
-                                        aligned_kps_dim, kps_is_big_endian,
-                                        0, 2 * kps_id + kps_points_number_));
-      const auto x_delta = mxnet_out_for_one_point[best_index];
+      float max_score = GetFloatByInt(max_value, kps_shift_);
+
+      // get delta, only the element at the best position is needed
+      int best_pos = max_h * row_stride + max_w;
+      int x_channel = 2 * kps_id + kps_points_number_;
+      const auto x_delta = GetRawInt(
+          box_feature, index[x_channel * channel_size + best_pos],
+          kps_is_big_endian);
       float fp_delta_x = GetFloatByInt(x_delta, kps_shift_) * pos_distance;
-
-      mxnet_out_for_one_point.assign(kps_feat_width_*kps_feat_height_, 0);
-      CHECK_HBRT_ERROR(hbrtConvertLayoutToNative1HW1(
-                                         mxnet_out_for_one_point.data(),
-                                         kps_feature + feature_size * box_id,
-                                         kps_layout_type_, kps_element_type,
-                                         aligned_kps_dim, kps_is_big_endian, 0,
-                                         2 * kps_id + kps_points_number_ + 1));
-      const auto y_delta = mxnet_out_for_one_point[best_index];
+      const auto y_delta = GetRawInt(
+          box_feature, index[(x_channel + 1) * channel_size + best_pos],
+          kps_is_big_endian);
       float fp_delta_y = GetFloatByInt(y_delta, kps_shift_) * pos_distance;
 
       Point point;
@@ -732,36 +987,87 @@ void FasterRCNNImp::GetKps(std::vector<Landmarks> &kpss,
   }
 }
 
+// convert the mask channel of one box into native, h * w elements
+void FasterRCNNImp::ConvertMask(const int32_t *mask_feature, size_t box_id,
+                                int32_t *native) {
+  int feature_size =
+      aligned_mask_dim.h * aligned_mask_dim.w * aligned_mask_dim.c;
+  CHECK_HBRT_ERROR(hbrtConvertLayoutToNative1HW1(
+                              native,
+                              mask_feature + feature_size * box_id,
+                              mask_layout_type_, mask_element_type,
+                              aligned_mask_dim, mask_is_big_endian,
+                              0, 0));
+}
+
 void FasterRCNNImp::GetMask(std::vector<Segmentation> &masks,
                             BPU_Buffer_Handle output,
                             const std::vector<BBox> &body_boxes) {
   size_t body_box_num = body_boxes.size();
   int32_t *mask_feature =
       reinterpret_cast<int32_t *>(BPU_getRawBufferPtr(output));
+  int mask_size = aligned_mask_dim.h * aligned_mask_dim.w;
+  std::vector<int32_t> native(mask_size);
 
-  std::vector<int32_t> mxnet_out_for_one_box(
-      aligned_mask_dim.h * aligned_mask_dim.w, 0);
-  int feature_size =
-      aligned_mask_dim.h * aligned_mask_dim.w * aligned_mask_dim.c;
+  masks.reserve(masks.size() + body_box_num);
   for (size_t box_id = 0; box_id < body_box_num; ++box_id) {
-    mxnet_out_for_one_box.assign(
-                        aligned_mask_dim.h * aligned_mask_dim.w, 0);
-    CHECK_HBRT_ERROR(hbrtConvertLayoutToNative1HW1(
-                                mxnet_out_for_one_box.data(),
-                                mask_feature + feature_size * box_id,
-                                mask_layout_type_, mask_element_type,
-                                aligned_mask_dim, mask_is_big_endian,
-                                0, 0));
-    float fp_for_this_mask;
+    ConvertMask(mask_feature, box_id, native.data());
     Segmentation mask;
-    for (int32_t mask_i = 0;
-         mask_i < aligned_mask_dim.h * aligned_mask_dim.w; ++mask_i) {
-      fp_for_this_mask =
-          GetFloatByInt(mxnet_out_for_one_box[mask_i], mask_shift_);
-      mask.values.push_back(fp_for_this_mask);
-    }
+    mask.values.resize(mask_size);
+    DequantizeInt(native.data(), mask_size, mask_shift_, mask.values.data());
+    mask.height = aligned_mask_dim.h;
+    mask.width = aligned_mask_dim.w;
+    masks.push_back(std::move(mask));
+  }
+}
+
+void FasterRCNNImp::GetCompactMask(std::vector<CompactSegmentation> &masks,
+                                   BPU_Buffer_Handle output,
+                                   const std::vector<BBox> &body_boxes) {
+  size_t body_box_num = body_boxes.size();
+  int32_t *mask_feature =
+      reinterpret_cast<int32_t *>(BPU_getRawBufferPtr(output));
+  int mask_size = aligned_mask_dim.h * aligned_mask_dim.w;
+  float unit = GetFloatByInt(1, mask_shift_);
+  std::vector<int32_t> native(mask_size);
+
+  masks.reserve(masks.size() + body_box_num);
+  for (size_t box_id = 0; box_id < body_box_num; ++box_id) {
+    ConvertMask(mask_feature, box_id, native.data());
+    CompactSegmentation mask;
     mask.height = aligned_mask_dim.h;
     mask.width = aligned_mask_dim.w;
+    if (mask_format_ == MaskFormat::UINT8) {
+      // linear quantization over the value range of this mask
+      mask.format = CompactSegmentation::Format::UINT8;
+      auto min_max = std::minmax_element(native.begin(), native.end());
+      int32_t min_value = *min_max.first;
+      int64_t range = static_cast<int64_t>(*min_max.second) - min_value;
+      mask.offset = min_value * unit;
+      mask.scale = range * unit / 255;
+      mask.data.resize(mask_size);
+      for (int i = 0; i < mask_size; ++i) {
+        mask.data[i] = range == 0 ? 0 : static_cast<uint8_t>(
+            ((native[i] - min_value) * int64_t(255) + range / 2) / range);
+      }
+    } else {
+      // threshold in the fixed point domain, then run length encode
+      mask.format = CompactSegmentation::Format::RLE;
+      mask.threshold = mask_threshold_;
+      float int_threshold = mask_threshold_ / unit;
+      bool current = false;
+      uint32_t run = 0;
+      for (int i = 0; i < mask_size; ++i) {
+        bool value = native[i] > int_threshold;
+        if (value != current) {
+          mask.runs.push_back(run);
+          run = 0;
+          current = value;
+        }
+        run++;
+      }
+      mask.runs.push_back(run);
+    }
     masks.push_back(std::move(mask));
   }
 }
@@ -1043,6 +1349,11 @@ void FasterRCNNImp::GetPlateRow(
 }
 
 void FasterRCNNImp::Finalize() {
+  post_process_group_ = nullptr;
+  if (fake_img_handle_) {
+    BPU_releaseFakeImageHandle(fake_img_handle_);
+    fake_img_handle_ = nullptr;
+  }
   hobot::vision::BPUModelManager::Get().ReleaseBpuHandle(model_file_path_);
   LOGD << "release " << model_file_path_ << "\n";
 }
@@ -3,7 +3,13 @@
 //
 
 #include "yuv_utils.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 
 void yuv420sp_to_yuv444(uint8_t* yuv420sp, int height, int width, uint8_t* yuv444_ptr) {
   uint8_t* y_ptr = yuv420sp;
@@ -67,3 +73,134 @@ void bgr_to_nv12(uint8_t *bgr, int height, int width, cv::Mat &img_nv12) {
   }
 }
 
+
+namespace {
+
+// fixed point bilinear weights, Q7
+const int kResizeShift = 7;
+const int kResizeOne = 1 << kResizeShift;
+
+struct ResizeTab {
+  int i0;  // first source index, already multiplied by channel number
+  int i1;
+  int w1;  // weight of i1, weight of i0 is kResizeOne - w1
+};
+
+// same sample positions as cv::INTER_LINEAR (half pixel centers)
+void build_resize_tab(int src_len, int dst_len, int mul,
+                      std::vector<ResizeTab> &tab) {
+  tab.resize(dst_len);
+  float scale = static_cast<float>(src_len) / dst_len;
+  for (int i = 0; i < dst_len; ++i) {
+    float pos = (i + 0.5f) * scale - 0.5f;
+    int i0 = static_cast<int>(std::floor(pos));
+    int w1 = static_cast<int>((pos - i0) * kResizeOne + 0.5f);
+    if (i0 < 0) {
+      i0 = 0;
+      w1 = 0;
+    }
+    if (i0 >= src_len - 1) {
+      i0 = src_len - 1;
+      w1 = 0;
+    }
+    int i1 = std::min(i0 + 1, src_len - 1);
+    tab[i].i0 = i0 * mul;
+    tab[i].i1 = i1 * mul;
+    tab[i].w1 = w1;
+  }
+}
+
+// resize one bgr row, dst_row has dst_width * 3 bytes
+void resize_bgr_row(const uint8_t *row0, const uint8_t *row1, int wy1,
+                    const std::vector<ResizeTab> &x_tab, uint8_t *dst_row) {
+  const int wy0 = kResizeOne - wy1;
+  const int round = 1 << (2 * kResizeShift - 1);
+  for (size_t x = 0; x < x_tab.size(); ++x) {
+    const ResizeTab &t = x_tab[x];
+    const int wx1 = t.w1;
+    const int wx0 = kResizeOne - wx1;
+    for (int c = 0; c < 3; ++c) {
+      int top = row0[t.i0 + c] * wx0 + row0[t.i1 + c] * wx1;
+      int bottom = row1[t.i0 + c] * wx0 + row1[t.i1 + c] * wx1;
+      *dst_row++ = static_cast<uint8_t>(
+          (top * wy0 + bottom * wy1 + round) >> (2 * kResizeShift));
+    }
+  }
+}
+
+inline uint8_t clamp_u8(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// y = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16
+void bgr_row_to_y(const uint8_t *bgr, int width, uint8_t *y) {
+  int x = 0;
+#ifdef __ARM_NEON
+  const uint8x8_t c66 = vdup_n_u8(66);
+  const uint8x8_t c129 = vdup_n_u8(129);
+  const uint8x8_t c25 = vdup_n_u8(25);
+  const uint16x8_t c128 = vdupq_n_u16(128);
+  const uint8x16_t c16 = vdupq_n_u8(16);
+  for (; x + 16 <= width; x += 16, bgr += 48, y += 16) {
+    uint8x16x3_t px = vld3q_u8(bgr);
+    uint16x8_t lo = vmlal_u8(c128, vget_low_u8(px.val[2]), c66);
+    lo = vmlal_u8(lo, vget_low_u8(px.val[1]), c129);
+    lo = vmlal_u8(lo, vget_low_u8(px.val[0]), c25);
+    uint16x8_t hi = vmlal_u8(c128, vget_high_u8(px.val[2]), c66);
+    hi = vmlal_u8(hi, vget_high_u8(px.val[1]), c129);
+    hi = vmlal_u8(hi, vget_high_u8(px.val[0]), c25);
+    uint8x16_t out = vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8));
+    vst1q_u8(y, vaddq_u8(out, c16));
+  }
+#endif
+  for (; x < width; ++x, bgr += 3) {
+    *y++ = static_cast<uint8_t>(
+        ((66 * bgr[2] + 129 * bgr[1] + 25 * bgr[0] + 128) >> 8) + 16);
+  }
+}
+
+// u/v are sampled from the top left pixel of each 2x2 block, as cvtColor
+void bgr_row_to_uv(const uint8_t *bgr, int width, uint8_t *uv) {
+  for (int x = 0; x < width; x += 2, bgr += 6) {
+    int b = bgr[0], g = bgr[1], r = bgr[2];
+    *uv++ = clamp_u8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    *uv++ = clamp_u8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  }
+}
+
+}  // namespace
+
+void bgr_resize_to_nv12(const uint8_t *bgr, int src_height, int src_width,
+                        int src_step, int dst_height, int dst_width,
+                        uint8_t *nv12) {
+  uint8_t *y_plane = nv12;
+  uint8_t *uv_plane = nv12 + dst_height * dst_width;
+  bool need_resize = src_height != dst_height || src_width != dst_width;
+
+  // per thread scratch, so that steady state runs without allocation
+  static thread_local std::vector<ResizeTab> x_tab;
+  static thread_local std::vector<ResizeTab> y_tab;
+  static thread_local std::vector<uint8_t> rows;
+  if (need_resize) {
+    build_resize_tab(src_width, dst_width, 3, x_tab);
+    build_resize_tab(src_height, dst_height, 1, y_tab);
+    rows.resize(dst_width * 3 * 2);
+  }
+
+  const int row_len = dst_width * 3;
+  for (int y = 0; y < dst_height; y += 2) {
+    const uint8_t *row[2];
+    for (int k = 0; k < 2; ++k) {
+      if (need_resize) {
+        const ResizeTab &t = y_tab[y + k];
+        resize_bgr_row(bgr + t.i0 * src_step, bgr + t.i1 * src_step, t.w1,
+                       x_tab, &rows[k * row_len]);
+        row[k] = &rows[k * row_len];
+      } else {
+        row[k] = bgr + (y + k) * src_step;
+      }
+      bgr_row_to_y(row[k], dst_width, y_plane + (y + k) * dst_width);
+    }
+    bgr_row_to_uv(row[0], dst_width, uv_plane + (y / 2) * dst_width);
+  }
+}
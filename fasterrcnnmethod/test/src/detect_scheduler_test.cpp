@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2026 Horizon Robotics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "FasterRCNNMethod/config.h"
+#include "FasterRCNNMethod/detect_scheduler.h"
+
+using faster_rcnn_method::BBox;
+using faster_rcnn_method::Config;
+using faster_rcnn_method::DetectScheduler;
+using faster_rcnn_method::DetectWindow;
+using faster_rcnn_method::FasterRCNNOutMsg;
+using faster_rcnn_method::FR_Config;
+
+// 1920x1080 source, layer 0 full size, layer 4 half size
+static const std::vector<std::pair<int, int>> kLayerSizes = {
+    {1920, 1080}, {960, 540}};
+
+static std::shared_ptr<Config> ScheduleConfig(int interval) {
+  FR_Config cfg;
+  cfg["full_detect_interval"] = interval;
+  cfg["roi_expand_ratio"] = 0.5;
+  cfg["roi_pyramid_layers"].append(0);
+  cfg["roi_pyramid_layers"].append(4);
+  return std::make_shared<Config>(cfg);
+}
+
+TEST(DETECT_SCHEDULER_TEST, Disabled) {
+  DetectScheduler scheduler;
+  scheduler.Init(nullptr, 4, 960, 540);
+  EXPECT_FALSE(scheduler.Enabled());
+  DetectWindow window;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, {{960, 540}}, &window));
+    EXPECT_TRUE(window.full_frame);
+  }
+}
+
+TEST(DETECT_SCHEDULER_TEST, WindowAndSkip) {
+  DetectScheduler scheduler;
+  scheduler.Init(ScheduleConfig(3), 4, 960, 540);
+  ASSERT_TRUE(scheduler.Enabled());
+  DetectWindow window;
+
+  // first frame of a channel is always full frame
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  EXPECT_TRUE(window.full_frame);
+
+  // a small face: window on the full resolution layer around it
+  FasterRCNNOutMsg det_result;
+  BBox face(1000, 600, 1040, 640);
+  det_result.boxes["face_box"].push_back(face);
+  scheduler.Update(0, det_result);
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  ASSERT_FALSE(window.full_frame);
+  EXPECT_EQ(window.pyramid_layer, 0);
+  EXPECT_LE(window.x, face.x1);
+  EXPECT_GE(window.x + 960, face.x2);
+  EXPECT_LE(window.y, face.y1);
+  EXPECT_GE(window.y + 540, face.y2);
+  EXPECT_EQ(window.x % 2, 0);
+  EXPECT_EQ(window.y % 2, 0);
+
+  // other channels keep their own schedule
+  EXPECT_TRUE(scheduler.Schedule(1, 1920, 1080, kLayerSizes, &window));
+  EXPECT_TRUE(window.full_frame);
+
+  // nothing detected and no entry zone: skip until the next full frame
+  scheduler.Update(0, FasterRCNNOutMsg());
+  EXPECT_FALSE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  EXPECT_TRUE(window.full_frame);
+}
+
+TEST(DETECT_SCHEDULER_TEST, CoarseLayerForLargeRegion) {
+  DetectScheduler scheduler;
+  scheduler.Init(ScheduleConfig(2), 4, 960, 540);
+  DetectWindow window;
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+
+  // spread out boxes do not fit a window of layer 0
+  FasterRCNNOutMsg det_result;
+  det_result.boxes["face_box"].push_back(BBox(100, 100, 140, 140));
+  det_result.boxes["face_box"].push_back(BBox(1700, 900, 1740, 940));
+  scheduler.Update(0, det_result);
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  ASSERT_FALSE(window.full_frame);
+  EXPECT_EQ(window.pyramid_layer, 4);
+  EXPECT_EQ(window.x, 0);
+  EXPECT_EQ(window.y, 0);
+  EXPECT_FLOAT_EQ(window.scale_x, 0.5f);
+}
+
+TEST(DETECT_SCHEDULER_TEST, RoiModelWindow) {
+  FR_Config cfg;
+  cfg["full_detect_interval"] = 2;
+  cfg["roi_pyramid_layers"].append(0);
+  cfg["roi_pyramid_layers"].append(4);
+  cfg["roi_model_name"] = "faceMultitask_roi";
+  cfg["roi_model_input_width"] = 480;
+  cfg["roi_model_input_height"] = 270;
+  DetectScheduler scheduler;
+  scheduler.Init(std::make_shared<Config>(cfg), 4, 960, 540);
+  EXPECT_EQ(scheduler.RoiModelName(), "faceMultitask_roi");
+  DetectWindow window;
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+
+  // the window has the roi model input size
+  FasterRCNNOutMsg det_result;
+  BBox face(1000, 600, 1040, 640);
+  det_result.boxes["face_box"].push_back(face);
+  scheduler.Update(0, det_result);
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  ASSERT_FALSE(window.full_frame);
+  EXPECT_EQ(window.pyramid_layer, 0);
+  EXPECT_LE(window.x, face.x1);
+  EXPECT_GE(window.x + 480, face.x2);
+  EXPECT_LE(window.y, face.y1);
+  EXPECT_GE(window.y + 270, face.y2);
+
+  // a region larger than a roi model window of layer 0 goes to layer 4
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  det_result.boxes["face_box"].push_back(BBox(1500, 600, 1540, 640));
+  scheduler.Update(0, det_result);
+  EXPECT_TRUE(scheduler.Schedule(0, 1920, 1080, kLayerSizes, &window));
+  ASSERT_FALSE(window.full_frame);
+  EXPECT_EQ(window.pyramid_layer, 4);
+  EXPECT_LE(window.x, 1000 / 2);
+  EXPECT_GE(window.x + 480, 1540 / 2);
+}
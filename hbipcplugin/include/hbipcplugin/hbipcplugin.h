@@ -9,6 +9,7 @@
 #ifndef HBIPCPLUGIN_INCLUDE_HBIPCPLUGIN_HBIPCPLUGIN_H_
 #define HBIPCPLUGIN_INCLUDE_HBIPCPLUGIN_HBIPCPLUGIN_H_
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 #include "hobot_vision/blocking_queue.hpp"
 
 #include "xpluginflow_msgtype/hbipcplugin_data.h"
+#include "xpluginflow_msgtype/smart_compact.h"
 #include "xpluginflow_msgtype/smartplugin_data.h"
 #include "xpluginflow_msgtype/vioplugin_data.h"
 
@@ -37,7 +39,9 @@ namespace hbipcplugin {
 
 #define TYPE_HBIPC_MESSAGE "XPLUGIN_HBIPC_MESSAGE"
 
+using horizon::vision::xpluginflow::basic_msgtype::CompactFrame;
 using horizon::vision::xpluginflow::basic_msgtype::HbipcMessage;
+using horizon::vision::xpluginflow::basic_msgtype::SmartCompactEncoder;
 using horizon::vision::xpluginflow::basic_msgtype::SmartMessage;
 using horizon::vision::xpluginflow::basic_msgtype::VioMessage;
 
@@ -69,12 +73,24 @@ class HbipcPlugin : public XPluginAsync {
   int Stop() override;
   // 返回plugin的名称
   std::string desc() const { return "HbipcPlugin"; }
+  // 序列化不含content_的MessagePack, 并追加content_字段的tag与长度,
+  // 之后直接拼接content_即为完整的MessagePack
+  static std::string PackHead(const pack::MessagePack &envelope,
+                              size_t content_size);
+  // 处理AP侧的控制请求(kXPluginCompact), 返回false表示不是控制请求
+  bool OnRequest(const std::string &proto);
+  // 智能帧当前是否以紧凑格式发送
+  bool compact_enabled() const { return compact_enabled_; }
 
  private:
   int OnGetSmartResult(const XPluginFlowMessagePtr msg);
   int OnGetDropResult(const XPluginFlowMessagePtr msg);
-  std::string SmartPack(std::shared_ptr<SmartMessage> msg);
-  std::string DropPack(std::shared_ptr<VioMessage> msg);
+  int SmartPack(std::shared_ptr<SmartMessage> msg);
+  // 以kXPluginCompact格式发送智能帧, 不支持时返回false
+  bool CompactPack(std::shared_ptr<SmartMessage> msg, int *ret);
+  int DropPack(std::shared_ptr<VioMessage> msg);
+  // 发送MessagePack头部与预先序列化的content_
+  int SendPack(const pack::MessagePack &envelope, XPluginFlowMessagePtr msg);
 
  private:
   void ExecLoop();
@@ -84,6 +100,13 @@ class HbipcPlugin : public XPluginAsync {
   std::atomic<bool> is_stop_;
   hobot::vision::BlockingQueue<std::shared_ptr<VioMessage>> droped_queue_;
   uint64_t last_smart_frame_id_ = 0;
+  // AP侧发送kXPluginCompact后, 智能帧改为紧凑格式;
+  // 初始化连接、接收出错或AP侧关闭时恢复原有格式
+  std::atomic<bool> compact_enabled_{false};
+  std::atomic<bool> compact_reset_{false};
+  SmartCompactEncoder compact_encoder_;
+  CompactFrame compact_frame_;
+  std::string compact_content_;
 };
 
 }  // namespace hbipcplugin
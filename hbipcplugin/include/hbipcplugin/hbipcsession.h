@@ -54,6 +54,8 @@ class HbipcSession : public hobot::CSingleton<HbipcSession> {
   int SGetSendErrorCode() const;
   int SGetRecvErrorCode() const;
   int SSend(const std::string &proto);
+  // 发送head与content拼接后的数据, 直接拷贝到发送缓冲区
+  int SSend(const std::string &head, const std::string &content);
   int SRecv(std::string *proto);
 
  private:
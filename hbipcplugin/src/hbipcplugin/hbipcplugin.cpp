@@ -23,7 +23,7 @@ namespace vision {
 namespace xpluginflow {
 namespace hbipcplugin {
 
-XPLUGIN_REGISTER_MSG_TYPE(XPLUGIN_HBIPC_MESSAGE)
+XPLUGIN_REGISTER_CONTROL_MSG_TYPE(XPLUGIN_HBIPC_MESSAGE)
 
 using std::chrono::milliseconds;
 
@@ -53,12 +53,19 @@ int HbipcPlugin::Init() {
   // RegisterMsg(TYPE_HBIPC_MESSAGE, std::bind(&HbipcPlugin::OnGetHbipcResult,
   //                                              this, std::placeholders::_1));
 
+  // 智能帧结果与丢帧结果尽量不丢弃：加大队列容量，hbipc发送持续阻塞时
+  // 丢弃最旧的结果，不阻塞总线分发线程
+  XMsgQueueConfig queue_config;
+  queue_config.capacity = 100;
+  queue_config.policy = XMsgQueuePolicy::DROP_OLDEST;
   // 注册智能帧结果
   RegisterMsg(TYPE_SMART_MESSAGE, std::bind(&HbipcPlugin::OnGetSmartResult,
-                                            this, std::placeholders::_1));
+                                            this, std::placeholders::_1),
+              queue_config);
   //注册主动丢帧结果
   RegisterMsg(TYPE_DROP_MESSAGE, std::bind(&HbipcPlugin::OnGetDropResult, this,
-                                           std::placeholders::_1));
+                                           std::placeholders::_1),
+              queue_config);
 
   // 初始化系统HBIPC接口
   if ((ret = HbipcSession::Instance().SInitConnection()) != ERROR_HBIPC_OK) {
@@ -66,6 +73,8 @@ int HbipcPlugin::Init() {
          << HbipcSession::Instance().SGetInitErrorCode();
     return ret;
   }
+  // 紧凑格式只对当前连接有效, 需要AP端重新声明
+  compact_enabled_ = false;
   // 调用父类初始化成员函数注册信息
   XPluginAsync::Init();
   droped_queue_.clear();
@@ -74,6 +83,7 @@ int HbipcPlugin::Init() {
 
 int HbipcPlugin::Deinit() {
   int ret = ERROR_HBIPC_OK;
+  compact_enabled_ = false;
   // 反初始化系统级的HBIPC接口
   if ((ret = HbipcSession::Instance().SDeinitConnection()) != ERROR_HBIPC_OK) {
     LOGE << "[HbipcPlugin] deinit HbipcSession, error code = "
@@ -91,7 +101,14 @@ void HbipcPlugin::ExecLoop() {
     if ((ret = HbipcSession::Instance().SRecv(&proto_)) != ERROR_HBIPC_OK) {
       LOGE << "[HbipcPlugin] hbipc recv, error code = "
            << HbipcSession::Instance().SGetRecvErrorCode();
+      // 链路异常时AP端可能已重启, 恢复原有格式直到AP端重新声明
+      if (compact_enabled_.exchange(false)) {
+        LOGW << "[HbipcPlugin] switch smart frames back to x2 encoding";
+      }
     } else {
+      if (OnRequest(proto_)) {
+        continue;
+      }
       auto msg = std::make_shared<CustomHbipcMessage>(proto_);
       PushMsg(msg);
       LOGD << "[HbipcPlugin] hbipc recv success";
@@ -99,6 +116,23 @@ void HbipcPlugin::ExecLoop() {
   } while (!is_stop_);
 }
 
+bool HbipcPlugin::OnRequest(const std::string &proto) {
+  pack::MessagePack request;
+  if (!request.ParseFromString(proto) ||
+      request.flow_() != pack::MessagePack_Flow_AP2CP ||
+      request.type_() != pack::MessagePack_Type_kXPluginCompact) {
+    return false;
+  }
+  // content_为"0"时关闭紧凑格式, 其他情况开启;
+  // 每次开启都从关键帧开始, AP侧重连后也能解码
+  bool enable = request.content_() != "0";
+  LOGI << "[HbipcPlugin] switch smart frames to "
+       << (enable ? "compact" : "x2") << " encoding";
+  compact_reset_ = true;
+  compact_enabled_ = enable;
+  return true;
+}
+
 int HbipcPlugin::Start() {
   is_stop_ = false;
   thread_ =
@@ -155,8 +189,34 @@ int HbipcPlugin::OnGetHbipcResult(XPluginFlowMessagePtr msg) {
 }
 #endif
 
-std::string HbipcPlugin::DropPack(std::shared_ptr<VioMessage> msg) {
-  std::string proto_str;
+std::string HbipcPlugin::PackHead(const pack::MessagePack &envelope,
+                                  size_t content_size) {
+  std::string head;
+  envelope.SerializeToString(&head);
+  // content_是最后一个字段, 按字段号顺序序列化时位于末尾;
+  // proto3不序列化空的bytes字段
+  if (content_size > 0) {
+    // field 4, wire type 2 (length-delimited)
+    head.push_back(static_cast<char>((4 << 3) | 2));
+    uint64_t size = content_size;
+    while (size >= 0x80) {
+      head.push_back(static_cast<char>((size & 0x7f) | 0x80));
+      size >>= 7;
+    }
+    head.push_back(static_cast<char>(size));
+  }
+  return head;
+}
+
+int HbipcPlugin::SendPack(const pack::MessagePack &envelope,
+                          XPluginFlowMessagePtr msg) {
+  // content_使用消息缓存的序列化结果, 不再拷贝进MessagePack
+  auto content = msg->SerializedData();
+  return HbipcSession::Instance().SSend(PackHead(envelope, content->size()),
+                                        *content);
+}
+
+int HbipcPlugin::DropPack(std::shared_ptr<VioMessage> msg) {
   pack::MessagePack proto_pack_message;
 
   LOGI << "[DROP]The drop frame seq:" << msg->sequence_id_
@@ -169,9 +229,7 @@ std::string HbipcPlugin::DropPack(std::shared_ptr<VioMessage> msg) {
   frame->set_sequence_id_(msg->sequence_id_);
   frame->set_timestamp_(msg->time_stamp_);
   frame->set_frame_type_(pack::Frame_FrameType_DropFrame);
-  proto_pack_message.set_content_(msg->Serialize());
-  proto_pack_message.SerializeToString(&proto_str);
-  return proto_str;
+  return SendPack(proto_pack_message, msg);
 }
 
 int HbipcPlugin::OnGetDropResult(XPluginFlowMessagePtr msg) {
@@ -198,8 +256,7 @@ int HbipcPlugin::OnGetDropResult(XPluginFlowMessagePtr msg) {
           }
         } else {
           cur_frame_id++;
-          if ((ret = HbipcSession::Instance().SSend(DropPack(drop_frame))) !=
-              ERROR_HBIPC_OK) {
+          if ((ret = DropPack(drop_frame)) != ERROR_HBIPC_OK) {
             LOGE << "[HbipcPlugin] hbipc send, error code = "
                  << HbipcSession::Instance().SGetSendErrorCode();
             return ret;
@@ -212,12 +269,40 @@ int HbipcPlugin::OnGetDropResult(XPluginFlowMessagePtr msg) {
   return ret;
 }
 
-std::string HbipcPlugin::SmartPack(std::shared_ptr<SmartMessage> msg) {
-  std::string proto_str;
+bool HbipcPlugin::CompactPack(std::shared_ptr<SmartMessage> msg, int *ret) {
+  if (!compact_enabled_ || !msg->GetCompactFrame(&compact_frame_)) {
+    return false;
+  }
+  if (compact_reset_.exchange(false)) {
+    compact_encoder_.ForceKeyframe();
+  }
+  compact_encoder_.Encode(compact_frame_, &compact_content_);
+
+  pack::MessagePack proto_pack_message;
+  proto_pack_message.set_flow_(pack::MessagePack_Flow_CP2AP);
+  proto_pack_message.set_type_(pack::MessagePack_Type_kXPluginCompact);
+  auto frame = proto_pack_message.mutable_addition_()->mutable_frame_();
+  frame->set_sequence_id_(msg->frame_id);
+  frame->set_timestamp_(msg->time_stamp);
+  frame->set_frame_type_(pack::Frame_FrameType_SmartFrame);
+  *ret = HbipcSession::Instance().SSend(
+      PackHead(proto_pack_message, compact_content_.size()), compact_content_);
+  if (*ret != ERROR_HBIPC_OK) {
+    // AP侧未收到这一帧, 之后的差分帧无法解码
+    compact_encoder_.ForceKeyframe();
+  }
+  return true;
+}
+
+int HbipcPlugin::SmartPack(std::shared_ptr<SmartMessage> msg) {
   pack::MessagePack proto_pack_message;
 
   LOGI << "[SMART]The smart frame seq:" << msg->frame_id
        << ", ts:" << msg->time_stamp;
+  int ret = ERROR_HBIPC_OK;
+  if (CompactPack(msg, &ret)) {
+    return ret;
+  }
 
   proto_pack_message.set_flow_(pack::MessagePack_Flow_CP2AP);
   proto_pack_message.set_type_(pack::MessagePack_Type_kXPlugin);
@@ -226,9 +311,7 @@ std::string HbipcPlugin::SmartPack(std::shared_ptr<SmartMessage> msg) {
   frame->set_sequence_id_(msg->frame_id);
   frame->set_timestamp_(msg->time_stamp);
   frame->set_frame_type_(pack::Frame_FrameType_SmartFrame);
-  proto_pack_message.set_content_(msg->Serialize());
-  proto_pack_message.SerializeToString(&proto_str);
-  return proto_str;
+  return SendPack(proto_pack_message, msg);
 }
 
 int HbipcPlugin::OnGetSmartResult(XPluginFlowMessagePtr msg) {
@@ -262,8 +345,7 @@ int HbipcPlugin::OnGetSmartResult(XPluginFlowMessagePtr msg) {
     LOGI << "[GET SMART]The smart frame seq:" << smart_message->frame_id
          << ", ts:" << smart_message->time_stamp;
     smart_time_last = smart_message->time_stamp;
-    if ((ret = HbipcSession::Instance().SSend(SmartPack(smart_message))) !=
-        ERROR_HBIPC_OK) {
+    if ((ret = SmartPack(smart_message)) != ERROR_HBIPC_OK) {
       LOGE << "[HbipcPlugin] hbipc send, error code = "
            << HbipcSession::Instance().SGetSendErrorCode();
       return ret;
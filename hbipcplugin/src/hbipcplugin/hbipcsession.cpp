@@ -137,7 +137,11 @@ int HbipcSession::SGetSendErrorCode() const { return send_error_code_; }
 int HbipcSession::SGetRecvErrorCode() const { return recv_error_code_; }
 
 int HbipcSession::SSend(const std::string &proto) {
-  const auto proto_size = proto.size();
+  return SSend(proto, std::string());
+}
+
+int HbipcSession::SSend(const std::string &head, const std::string &content) {
+  const auto proto_size = head.size() + content.size();
   /* default 256K */
   if (proto_size > buf_len_max_) {
     LOGE << "[HbipcPlugin] size > BUF_LEN, "
@@ -145,7 +149,8 @@ int HbipcSession::SSend(const std::string &proto) {
     return ERROR_HBIPC_SEND;
   }
 
-  std::memcpy(send_proto_buf_, proto.c_str(), proto_size);
+  std::memcpy(send_proto_buf_, head.data(), head.size());
+  std::memcpy(send_proto_buf_ + head.size(), content.data(), content.size());
   LOGD << "[HbipcPlugin] hbipc_cp_send begin";
 
   time_point_ = hobot::Timer::tic();
@@ -71,4 +71,136 @@ TEST_F(HbipcPluginTest, API) {
   sc_plg->Deinit();
 
   LOGI << "Test hbipcplugin api file success";
-}
\ No newline at end of file
+}
+TEST(HbipcPluginPack, PackHead) {
+  pack::MessagePack proto_pack_message;
+  proto_pack_message.set_flow_(pack::MessagePack_Flow_CP2AP);
+  proto_pack_message.set_type_(pack::MessagePack_Type_kXPlugin);
+  auto frame = proto_pack_message.mutable_addition_()->mutable_frame_();
+  frame->set_sequence_id_(1);
+  frame->set_timestamp_(123456789);
+  frame->set_frame_type_(pack::Frame_FrameType_SmartFrame);
+  // 头部+content与完整序列化的MessagePack一致
+  for (size_t size : {0, 1, 127, 128, 200000}) {
+    std::string content(size, 'x');
+    auto head = HbipcPlugin::PackHead(proto_pack_message, content.size());
+    pack::MessagePack full_message = proto_pack_message;
+    full_message.set_content_(content);
+    std::string full;
+    full_message.SerializeToString(&full);
+    EXPECT_EQ(head + content, full);
+  }
+}
+
+TEST(HbipcPluginPack, CompactFrame) {
+  using horizon::vision::xpluginflow::basic_msgtype::CompactAttr;
+  using horizon::vision::xpluginflow::basic_msgtype::CompactFrame;
+  using horizon::vision::xpluginflow::basic_msgtype::CompactTarget;
+  using horizon::vision::xpluginflow::basic_msgtype::SmartCompactDecoder;
+  using horizon::vision::xpluginflow::basic_msgtype::SmartCompactEncoder;
+  namespace compact = horizon::vision::xpluginflow::basic_msgtype;
+
+  SmartCompactEncoder encoder(10);
+  SmartCompactDecoder decoder, late_decoder;
+  std::string data;
+  for (int i = 0; i < 30; i++) {
+    CompactFrame frame;
+    frame.frame_id = i;
+    frame.timestamp = 1000 + i * 40;
+    for (int id = 0; id < 3; id++) {
+      CompactTarget face;
+      face.type = compact::kCompactFace;
+      face.track_id = id;
+      face.has_box = true;
+      face.box[0].x = 100.25f * id + i;
+      face.box[0].y = 50.5f + i;
+      face.box[0].score = 0.5f;
+      face.box[1].x = face.box[0].x + 80;
+      face.box[1].y = face.box[0].y + 80;
+      face.box[1].score = 0.5f;
+      // 年龄只在部分帧中出现
+      if (i % 4 != 3) {
+        CompactAttr age;
+        age.type = compact::kCompactAge;
+        age.value = 20 + i / 5;
+        age.score = 0.75f;
+        face.attrs.push_back(age);
+      }
+      frame.targets.push_back(face);
+    }
+    CompactTarget lmk;
+    lmk.type = compact::kCompactLmk;
+    lmk.points.resize(5);
+    for (size_t k = 0; k < lmk.points.size(); k++) {
+      lmk.points[k].x = 10.f * k + i;
+      lmk.points[k].y = 20.f * k;
+      lmk.points[k].score = 1.f;
+    }
+    frame.targets.push_back(lmk);
+
+    encoder.Encode(frame, &data);
+    CompactFrame decoded;
+    ASSERT_TRUE(decoder.Decode(data, &decoded));
+    EXPECT_EQ(decoded.frame_id, frame.frame_id);
+    EXPECT_EQ(decoded.timestamp, frame.timestamp);
+    ASSERT_EQ(decoded.targets.size(), frame.targets.size());
+    for (size_t t = 0; t < frame.targets.size(); t++) {
+      auto &expect = frame.targets[t];
+      auto &actual = decoded.targets[t];
+      EXPECT_EQ(actual.type, expect.type);
+      EXPECT_EQ(actual.track_id, expect.track_id);
+      EXPECT_EQ(actual.has_box, expect.has_box);
+      for (int k = 0; expect.has_box && k < 2; k++) {
+        EXPECT_FLOAT_EQ(actual.box[k].x, expect.box[k].x);
+        EXPECT_FLOAT_EQ(actual.box[k].y, expect.box[k].y);
+        EXPECT_FLOAT_EQ(actual.box[k].score, expect.box[k].score);
+      }
+      ASSERT_EQ(actual.points.size(), expect.points.size());
+      for (size_t k = 0; k < expect.points.size(); k++) {
+        EXPECT_FLOAT_EQ(actual.points[k].x, expect.points[k].x);
+        EXPECT_FLOAT_EQ(actual.points[k].y, expect.points[k].y);
+      }
+      ASSERT_EQ(actual.attrs.size(), expect.attrs.size());
+      for (size_t k = 0; k < expect.attrs.size(); k++) {
+        EXPECT_EQ(actual.attrs[k].type, expect.attrs[k].type);
+        EXPECT_EQ(actual.attrs[k].value, expect.attrs[k].value);
+      }
+    }
+    // 第1帧之后才加入的解码端需等到下一个关键帧
+    if (i > 0) {
+      CompactFrame late;
+      EXPECT_EQ(late_decoder.Decode(data, &late), i >= 10);
+    }
+  }
+}
+
+TEST(HbipcPluginPack, CompactRequest) {
+  HbipcPlugin plugin;
+  EXPECT_FALSE(plugin.compact_enabled());
+
+  pack::MessagePack request;
+  request.set_flow_(pack::MessagePack_Flow_AP2CP);
+  request.set_type_(pack::MessagePack_Type_kXPluginCompact);
+  std::string proto;
+  request.SerializeToString(&proto);
+  // 控制请求不会作为HbipcMessage转发
+  EXPECT_TRUE(plugin.OnRequest(proto));
+  EXPECT_TRUE(plugin.compact_enabled());
+
+  request.set_content_("0");
+  request.SerializeToString(&proto);
+  EXPECT_TRUE(plugin.OnRequest(proto));
+  EXPECT_FALSE(plugin.compact_enabled());
+
+  // 其他类型或方向的消息不是控制请求
+  request.set_content_("1");
+  request.set_flow_(pack::MessagePack_Flow_CP2AP);
+  request.SerializeToString(&proto);
+  EXPECT_FALSE(plugin.OnRequest(proto));
+  request.set_flow_(pack::MessagePack_Flow_AP2CP);
+  request.set_type_(pack::MessagePack_Type_kXPlugin);
+  request.SerializeToString(&proto);
+  EXPECT_FALSE(plugin.OnRequest(proto));
+  EXPECT_FALSE(plugin.OnRequest("\xff\xff\xff"));
+  EXPECT_FALSE(plugin.compact_enabled());
+}
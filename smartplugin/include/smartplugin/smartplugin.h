@@ -46,6 +46,14 @@ struct CustomSmartMessage : SmartMessage {
     type_ = TYPE_SMART_MESSAGE;
   }
   std::string Serialize() override;
+  // serialize into buffer, resized to the message size which is returned
+  int SerializeTo(std::string *buffer);
+  bool GetCompactFrame(
+      horizon::vision::xpluginflow::basic_msgtype::CompactFrame *frame)
+      override;
+  // serialize feature_list into the capture message, "feature_uplink" of
+  // the smart config
+  bool feature_uplink = false;
 
  private:
   HobotXRoc::OutputDataPtr smart_result;
@@ -73,6 +81,7 @@ class SmartPlugin : public XPluginAsync {
   std::string xroc_workflow_cfg_file_;
   bool enable_profile_{false};
   std::string profile_log_file_;
+  bool feature_uplink_{false};
 };
 
 }  // namespace smartplugin
@@ -20,6 +20,7 @@
 #include "xpluginflow/message/pluginflow/msg_registry.h"
 #include "xpluginflow/plugin/xpluginasync.h"
 
+#include "hobotxsdk/compact_feature.h"
 #include "hobotxsdk/xroc_sdk.h"
 #include "horizon/vision/util.h"
 #include "horizon/vision_type/vision_error.h"
@@ -52,11 +53,118 @@ using horizon::iot::Convertor;
 
 XPLUGIN_REGISTER_MSG_TYPE(XPLUGIN_SMART_MESSAGE)
 
+namespace {
+// type_ strings assigned per element; set_type_(const char *) would build a
+// temporary std::string each time
+const std::string kTypeFace = "face";
+const std::string kTypeHead = "head";
+const std::string kTypeBody = "body";
+const std::string kTypeLmk = "lmk";
+const std::string kTypeKps = "kps";
+const std::string kTypeLandmarks = "landmarks";
+const std::string kTypeAge = "age";
+const std::string kTypeGender = "gender";
+const std::string kTypeFeature = "feature";
+const std::string kTypeFeatureInt8 = "feature_int8";
+const std::string kTypeFeatureFp16 = "feature_fp16";
+
+const std::string *BoxType(const std::string &output_name) {
+  if (output_name == "face_bbox_list") {
+    return &kTypeFace;
+  } else if (output_name == "head_box") {
+    return &kTypeHead;
+  } else if (output_name == "body_box") {
+    return &kTypeBody;
+  }
+  return nullptr;
+}
+
+/**
+ * FrameMessage reused by the serializing thread. FrameMessage::Clear()
+ * deletes its sub-messages, so they are cleared in place instead: the
+ * repeated fields keep their cleared elements for the next Add. The
+ * capture message is parked while unused, so that a frame without
+ * features still serializes without it.
+ */
+struct FrameMessageCache {
+  x2::FrameMessage frame;
+  std::unique_ptr<x2::CaptureFrameMessage> spare_capture;
+
+  x2::SmartFrameMessage *Reset() {
+    if (frame.has_capture_msg_()) {
+      spare_capture.reset(frame.release_capture_msg_());
+      spare_capture->Clear();
+    }
+    auto smart_msg = frame.mutable_smart_msg_();
+    smart_msg->Clear();
+    return smart_msg;
+  }
+
+  x2::CaptureFrameMessage *MutableCapture() {
+    if (!frame.has_capture_msg_() && spare_capture) {
+      frame.set_allocated_capture_msg_(spare_capture.release());
+    }
+    return frame.mutable_capture_msg_();
+  }
+};
+// output of the workflow by name, nullptr if it is not an output
+HobotXRoc::BaseDataVector *FindOutput(const HobotXRoc::OutputDataPtr &result,
+                                      const std::string &name) {
+  for (const auto &output : result->datas_) {
+    if (output->name_ == name) {
+      return dynamic_cast<HobotXRoc::BaseDataVector *>(output.get());
+    }
+  }
+  return nullptr;
+}
+
+// feature_list holds one BaseDataVector of features per person
+bool HasValidFeature(const HobotXRoc::BaseDataVector *feat_list) {
+  for (const auto &person : feat_list->datas_) {
+    auto features = dynamic_cast<HobotXRoc::BaseDataVector *>(person.get());
+    if (!features) {
+      continue;
+    }
+    for (const auto &feature : features->datas_) {
+      if (feature->state_ == HobotXRoc::DataState::VALID) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// track id of the person-th entry of snap_list (the input of the
+// face_feature CNNMethod, in the same order as feature_list), -1 if unknown
+int32_t SnapTrackId(const HobotXRoc::BaseDataVector *snap_list,
+                    size_t person) {
+  using SnapshotInfoPtr =
+      std::shared_ptr<hobot::vision::SnapshotInfo<HobotXRoc::BaseDataPtr>>;
+  if (!snap_list || person >= snap_list->datas_.size()) {
+    return -1;
+  }
+  auto snaps = dynamic_cast<HobotXRoc::BaseDataVector *>(
+      snap_list->datas_[person].get());
+  if (!snaps || snaps->datas_.empty()) {
+    return -1;
+  }
+  auto snap = std::dynamic_pointer_cast<HobotXRoc::XRocData<SnapshotInfoPtr>>(
+      snaps->datas_[0]);
+  return snap && snap->value ? snap->value->track_id : -1;
+}
+}  // namespace
+
 std::string CustomSmartMessage::Serialize() {
-  // serialize smart message using defined smart protobuf.
   std::string proto_str;
-  x2::FrameMessage proto_frame_message;
-  auto smart_msg = proto_frame_message.mutable_smart_msg_();
+  SerializeTo(&proto_str);
+  return proto_str;
+}
+
+int CustomSmartMessage::SerializeTo(std::string *buffer) {
+  // serialize smart message using defined smart protobuf.
+  static thread_local FrameMessageCache cache;
+  auto &proto_frame_message = cache.frame;
+  auto smart_msg = cache.Reset();
   smart_msg->set_timestamp_(time_stamp);
   smart_msg->set_error_code_(0);
   // user-defined output parsing declaration.
@@ -64,8 +172,8 @@ std::string CustomSmartMessage::Serialize() {
   HobotXRoc::BaseDataVector *lmks = nullptr;
   for (const auto &output : smart_result->datas_) {
     LOGD << "output name: " << output->name_;
-    if (output->name_ == "face_bbox_list" || output->name_ == "head_box" ||
-        output->name_ == "body_box") {
+    auto box_type = BoxType(output->name_);
+    if (box_type) {
       face_boxes = dynamic_cast<HobotXRoc::BaseDataVector *>(output.get());
       LOGD << "box size: " << face_boxes->datas_.size();
       for (int i = 0; i < face_boxes->datas_.size(); ++i) {
@@ -76,22 +184,10 @@ std::string CustomSmartMessage::Serialize() {
              << " x2: " << face_box->value.x2 << " y2: " << face_box->value.y2
              << " " << output->name_ << " id: " << face_box->value.id << "\n";
         auto target = smart_msg->add_targets_();
-        if (output->name_ == "face_bbox_list") {
-          target->set_type_("face");
-        } else if (output->name_ == "head_box") {
-          target->set_type_("head");
-        } else if (output->name_ == "body_box") {
-          target->set_type_("body");
-        }
+        target->set_type_(*box_type);
         target->set_track_id_(face_box->value.id);
         auto proto_box = target->add_boxes_();
-        if (output->name_ == "face_bbox_list") {
-          proto_box->set_type_("face");
-        } else if (output->name_ == "head_box") {
-          proto_box->set_type_("head");
-        } else if (output->name_ == "body_box") {
-          proto_box->set_type_("body");
-        }
+        proto_box->set_type_(*box_type);
         auto point1 = proto_box->mutable_top_left_();
         point1->set_x_(face_box->value.x1);
         point1->set_y_(face_box->value.y1);
@@ -111,9 +207,9 @@ std::string CustomSmartMessage::Serialize() {
         LOGD << "size " << lmk->value.values.size()
              << "score: " << lmk->value.score << "\n";
         auto target = smart_msg->add_targets_();
-        target->set_type_("lmk");
+        target->set_type_(kTypeLmk);
         auto proto_points = target->add_points_();
-        proto_points->set_type_("landmarks");
+        proto_points->set_type_(kTypeLandmarks);
         for (int i = 0; i < lmk->value.values.size(); ++i) {
           auto point = proto_points->add_points_();
           point->set_x_(lmk->value.values[i].x);
@@ -134,9 +230,9 @@ std::string CustomSmartMessage::Serialize() {
         LOGD << "size " << lmk->value.values.size()
              << "score: " << lmk->value.score << "\n";
         auto target = smart_msg->add_targets_();
-        target->set_type_("kps");
+        target->set_type_(kTypeKps);
         auto proto_points = target->add_points_();
-        proto_points->set_type_("landmarks");
+        proto_points->set_type_(kTypeLandmarks);
         for (int i = 0; i < lmk->value.values.size(); ++i) {
           auto point = proto_points->add_points_();
           point->set_x_(lmk->value.values[i].x);
@@ -160,7 +256,7 @@ std::string CustomSmartMessage::Serialize() {
         }
         auto target = smart_msg->mutable_targets_(i);
         auto attrs = target->add_attributes_();
-        attrs->set_type_("age");
+        attrs->set_type_(kTypeAge);
         attrs->set_value_((age->value.min + age->value.max) / 2);
         attrs->set_score_(age->value.score);
 
@@ -178,7 +274,7 @@ std::string CustomSmartMessage::Serialize() {
         }
         auto target = smart_msg->mutable_targets_(i);
         auto attrs = target->add_attributes_();
-        attrs->set_type_("gender");
+        attrs->set_type_(kTypeGender);
         attrs->set_value_(gender->value.value);
         attrs->set_score_(gender->value.score);
         LOGD << " " << gender->value.value;
@@ -187,24 +283,169 @@ std::string CustomSmartMessage::Serialize() {
     if (output->name_ == "feature_list") {
       auto feat_list = dynamic_cast<HobotXRoc::BaseDataVector*>(output.get());
       LOGD << "feature list size: " << feat_list->datas_.size();
+      if (!feature_uplink) {
+        continue;
+      }
+      // a frame without a valid feature carries no capture message,
+      // otherwise there is one capture target per person of the list
+      if (!HasValidFeature(feat_list)) {
+        continue;
+      }
+      auto snap_list = FindOutput(smart_result, "snap_list");
+      auto capture_msg = cache.MutableCapture();
       for (int i = 0; i < feat_list->datas_.size(); i++) {
-        auto one_person_feature_list = std::static_pointer_cast<
-        HobotXRoc::BaseDataVector>(feat_list->datas_[i]);
+        auto capture_target = capture_msg->add_targets_();
+        capture_target->set_type_(kTypeFace);
+        capture_target->set_track_id_(SnapTrackId(snap_list, i));
+        auto one_person_feature_list = dynamic_cast<
+            HobotXRoc::BaseDataVector *>(feat_list->datas_[i].get());
+        if (!one_person_feature_list) {
+          continue;
+        }
         for (int j = 0; j < one_person_feature_list->datas_.size(); j++) {
-          auto feature = std::static_pointer_cast<
-          HobotXRoc::XRocData<hobot::vision::Feature>>(
-            one_person_feature_list->datas_[j]);
-          LOGD << "feature:";
-          for (int k = 0; k < feature->value.values.size(); k++) {
-            LOGD << " " << feature->value.values[k];
+          const auto &one_feature = one_person_feature_list->datas_[j];
+          if (one_feature->state_ != HobotXRoc::DataState::VALID) {
+            continue;
+          }
+          auto capture = capture_target->add_captures_();
+          capture->set_type_(kTypeFace);
+          if (one_feature->type_ == COMPACT_FEATURE_TYPE) {
+            // int8: 4 bytes float scale followed by dim int8 values,
+            // fp16: dim ieee half values
+            auto feature = std::static_pointer_cast<
+            HobotXRoc::XRocData<HobotXRoc::CompactFeature>>(one_feature);
+            auto char_array = capture->add_char_arrays_();
+            auto bytes = char_array->mutable_array_();
+            if (feature->value.format ==
+                HobotXRoc::CompactFeature::Format::INT8) {
+              char_array->set_type_(kTypeFeatureInt8);
+              bytes->reserve(sizeof(float) + feature->value.data.size());
+              bytes->append(
+                  reinterpret_cast<const char *>(&feature->value.scale),
+                  sizeof(float));
+            } else {
+              char_array->set_type_(kTypeFeatureFp16);
+            }
+            bytes->append(
+                reinterpret_cast<const char *>(feature->value.data.data()),
+                feature->value.data.size());
+            LOGD << "compact feature, bytes: " << bytes->size();
+          } else {
+            auto feature = std::static_pointer_cast<
+            HobotXRoc::XRocData<hobot::vision::Feature>>(one_feature);
+            auto float_array = capture->add_float_arrays_();
+            float_array->set_type_(kTypeFeature);
+            float_array->mutable_value_()->Reserve(
+                feature->value.values.size());
+            for (int k = 0; k < feature->value.values.size(); k++) {
+              float_array->add_value_(feature->value.values[k]);
+            }
+            LOGD << "float feature, dim: " << feature->value.values.size();
           }
         }
       }
     }
   }
-  proto_frame_message.SerializeToString(&proto_str);
-  return proto_str;
+  // serialize into the caller's buffer, reusing its capacity
+  int size = proto_frame_message.ByteSize();
+  buffer->resize(size);
+  if (size > 0) {
+    proto_frame_message.SerializeWithCachedSizesToArray(
+        reinterpret_cast<google::protobuf::uint8 *>(&(*buffer)[0]));
+  }
+  return size;
+}
+bool CustomSmartMessage::GetCompactFrame(
+    horizon::vision::xpluginflow::basic_msgtype::CompactFrame *frame) {
+  using horizon::vision::xpluginflow::basic_msgtype::CompactAttr;
+  using horizon::vision::xpluginflow::basic_msgtype::CompactPoint;
+  using horizon::vision::xpluginflow::basic_msgtype::CompactTarget;
+  namespace compact = horizon::vision::xpluginflow::basic_msgtype;
+  frame->frame_id = frame_id;
+  frame->timestamp = time_stamp;
+  auto &targets = frame->targets;
+  targets.clear();
+  // same targets and order as SerializeTo
+  for (const auto &output : smart_result->datas_) {
+    const auto &name = output->name_;
+    auto datas = dynamic_cast<HobotXRoc::BaseDataVector *>(output.get());
+    if (!datas) {
+      continue;
+    }
+    if (name == "feature_list") {
+      // captures are only carried by x2::FrameMessage, a frame whose
+      // capture message would be empty (see SerializeTo) stays compact
+      if (feature_uplink && HasValidFeature(datas)) {
+        return false;
+      }
+      continue;
+    }
+    uint8_t box_type = compact::kCompactUnknown;
+    if (name == "face_bbox_list") {
+      box_type = compact::kCompactFace;
+    } else if (name == "head_box") {
+      box_type = compact::kCompactHead;
+    } else if (name == "body_box") {
+      box_type = compact::kCompactBody;
+    }
+    if (box_type != compact::kCompactUnknown) {
+      for (const auto &data : datas->datas_) {
+        auto &box = std::static_pointer_cast<
+            HobotXRoc::XRocData<hobot::vision::BBox>>(data)->value;
+        CompactTarget target;
+        target.type = box_type;
+        target.track_id = box.id;
+        target.has_box = true;
+        target.box[0].x = box.x1;
+        target.box[0].y = box.y1;
+        target.box[0].score = box.score;
+        target.box[1].x = box.x2;
+        target.box[1].y = box.y2;
+        target.box[1].score = box.score;
+        targets.push_back(std::move(target));
+      }
+    } else if (name == "lmk" || name == "kps") {
+      for (const auto &data : datas->datas_) {
+        auto &lmk = std::static_pointer_cast<
+            HobotXRoc::XRocData<hobot::vision::Landmarks>>(data)->value;
+        CompactTarget target;
+        target.type = name == "lmk" ? compact::kCompactLmk
+                                    : compact::kCompactKps;
+        target.points.resize(lmk.values.size());
+        for (size_t i = 0; i < lmk.values.size(); ++i) {
+          target.points[i].x = lmk.values[i].x;
+          target.points[i].y = lmk.values[i].y;
+          target.points[i].score = lmk.values[i].score;
+        }
+        targets.push_back(std::move(target));
+      }
+    } else if (name == "age" || name == "gender") {
+      // attached to the i-th target, as in SerializeTo
+      for (size_t i = 0; i < datas->datas_.size() && i < targets.size();
+           ++i) {
+        CompactAttr attr;
+        if (name == "age") {
+          auto &age = std::static_pointer_cast<
+              HobotXRoc::XRocData<hobot::vision::Age>>(datas->datas_[i])
+              ->value;
+          attr.type = compact::kCompactAge;
+          attr.value = (age.min + age.max) / 2;
+          attr.score = age.score;
+        } else {
+          auto &gender = std::static_pointer_cast<
+              HobotXRoc::XRocData<hobot::vision::Gender>>(datas->datas_[i])
+              ->value;
+          attr.type = compact::kCompactGender;
+          attr.value = gender.value;
+          attr.score = gender.score;
+        }
+        targets[i].attrs.push_back(attr);
+      }
+    }
+  }
+  return true;
 }
+
 SmartPlugin::SmartPlugin(const std::string &config_file) {
   config_file_ = config_file;
   LOGI << "smart config file:" << config_file_;
@@ -220,9 +461,11 @@ void SmartPlugin::ParseConfig() {
   xroc_workflow_cfg_file_ = config_->GetSTDStringValue("xroc_workflow_file");
   enable_profile_ = config_->GetBoolValue("enable_profile");
   profile_log_file_ = config_->GetSTDStringValue("profile_log_path");
+  feature_uplink_ = config_->GetBoolValue("feature_uplink");
   LOGI << "xroc_workflow_file:" << xroc_workflow_cfg_file_;
   LOGI << "enable_profile:" << enable_profile_
        << ", profile_log_path:" << profile_log_file_;
+  LOGI << "feature_uplink:" << feature_uplink_;
 }
 
 int SmartPlugin::Init() {
@@ -275,6 +518,7 @@ void SmartPlugin::OnCallback(HobotXRoc::OutputDataPtr xroc_out) {
   }
 
   auto smart_msg = std::make_shared<CustomSmartMessage>(xroc_out);
+  smart_msg->feature_uplink = feature_uplink_;
   // Set origin input named "image" as output always.
   HOBOT_CHECK(rgb_image);
   smart_msg->time_stamp = rgb_image->value->time_stamp;
@@ -282,7 +526,7 @@ void SmartPlugin::OnCallback(HobotXRoc::OutputDataPtr xroc_out) {
   auto input = monitor_->PopFrame(smart_msg->frame_id);
   delete static_cast<SmartInput *>(input.context);
   // PushMsg(smart_msg);
-  smart_msg->Serialize();
+  // x2序列化在发送时通过SerializedData按需完成, 紧凑格式发送的帧不需要
 }
 }  // namespace smartplugin
 }  // namespace xpluginflow
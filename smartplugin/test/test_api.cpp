@@ -10,6 +10,8 @@
  */
 #include "gtest/gtest.h"
 #include "hobotlog/hobotlog.hpp"
+#include "hobotxsdk/compact_feature.h"
+#include "horizon/vision_type/vision_type.hpp"
 #include "smartplugin/smartplugin.h"
 #include <sys/utsname.h>
 
@@ -27,4 +29,61 @@ TEST(smartplugin, api) {
   LOGI << "Test smartplugin api file success";
 }
 
+using horizon::vision::xpluginflow::basic_msgtype::CompactFrame;
+using horizon::vision::xpluginflow::smartplugin::CustomSmartMessage;
+
+HobotXRoc::OutputDataPtr MakeOutput(int feature_persons, bool valid) {
+  auto out = std::make_shared<HobotXRoc::OutputData>();
+  auto boxes = std::make_shared<HobotXRoc::BaseDataVector>();
+  boxes->name_ = "face_bbox_list";
+  for (int i = 0; i < 2; i++) {
+    auto box = std::make_shared<HobotXRoc::XRocData<hobot::vision::BBox>>();
+    box->value = hobot::vision::BBox(10 + i, 20, 110 + i, 120);
+    box->value.id = i + 1;
+    boxes->datas_.push_back(box);
+  }
+  out->datas_.push_back(boxes);
+  // one feature list per person, as output by the face_feature CNNMethod
+  auto feat_list = std::make_shared<HobotXRoc::BaseDataVector>();
+  feat_list->name_ = "feature_list";
+  for (int i = 0; i < feature_persons; i++) {
+    auto features = std::make_shared<HobotXRoc::BaseDataVector>();
+    auto feature =
+        std::make_shared<HobotXRoc::XRocData<HobotXRoc::CompactFeature>>();
+    feature->type_ = COMPACT_FEATURE_TYPE;
+    if (!valid) {
+      feature->state_ = HobotXRoc::DataState::INVALID;
+    }
+    features->datas_.push_back(feature);
+    feat_list->datas_.push_back(features);
+  }
+  out->datas_.push_back(feat_list);
+  return out;
+}
+
+TEST(smartplugin, compact_frame) {
+  CompactFrame frame;
+  // an empty feature_list does not prevent the compact encoding
+  CustomSmartMessage empty(MakeOutput(0, true));
+  empty.feature_uplink = true;
+  empty.frame_id = 7;
+  ASSERT_TRUE(empty.GetCompactFrame(&frame));
+  EXPECT_EQ(7u, frame.frame_id);
+  ASSERT_EQ(2u, frame.targets.size());
+  EXPECT_EQ(1, frame.targets[0].track_id);
+  EXPECT_EQ(2, frame.targets[1].track_id);
+
+  // neither do persons without a valid feature
+  CustomSmartMessage invalid(MakeOutput(2, false));
+  invalid.feature_uplink = true;
+  EXPECT_TRUE(invalid.GetCompactFrame(&frame));
+
+  // features are only sent in x2::FrameMessage
+  CustomSmartMessage features(MakeOutput(2, true));
+  features.feature_uplink = true;
+  EXPECT_FALSE(features.GetCompactFrame(&frame));
+  features.feature_uplink = false;
+  EXPECT_TRUE(features.GetCompactFrame(&frame));
+}
+
 }
\ No newline at end of file
@@ -23,7 +23,7 @@
 #include "xpluginflow_msgtype/protobuf/x2.pb.h"
 
 XPLUGIN_REGISTER_MSG_TYPE(XPLUGIN_IMAGE_MESSAGE)
-XPLUGIN_REGISTER_MSG_TYPE(XPLUGIN_DROP_MESSAGE)
+XPLUGIN_REGISTER_CONTROL_MSG_TYPE(XPLUGIN_DROP_MESSAGE)
 
 namespace horizon {
 namespace vision {
@@ -96,9 +96,15 @@ int VioPlugin::Init() {
   VioProduceHandle_ = VioProduce::CreateVioProduce(data_source_);
   HOBOT_CHECK(VioProduceHandle_);
   VioProduceHandle_->SetConfig(config_);
-  // 注册智能帧结果
+  // 注册AP下发的配置消息，配置不能丢弃：队列满时阻塞推送线程等待
+  // 消费(BLOCK)，而不是丢弃最旧的配置。配置消息是CONTROL优先级且
+  // 频率很低，正常情况下队列不会满
+  XMsgQueueConfig queue_config;
+  queue_config.capacity = 100;
+  queue_config.policy = XMsgQueuePolicy::BLOCK;
   RegisterMsg(TYPE_HBIPC_MESSAGE, std::bind(&VioPlugin::OnGetHbipcResult, this,
-                                            std::placeholders::_1));
+                                            std::placeholders::_1),
+              queue_config);
   // 调用父类初始化成员函数注册信息
   XPluginAsync::Init();
   return 0;
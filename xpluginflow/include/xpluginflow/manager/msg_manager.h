@@ -15,7 +15,9 @@
 
 #ifndef XPLUGINFLOW_INCLUDE_XPLUGINFLOW_MANAGER_MSG_MANAGER_H_
 #define XPLUGINFLOW_INCLUDE_XPLUGINFLOW_MANAGER_MSG_MANAGER_H_
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -30,50 +32,175 @@
 namespace horizon {
 namespace vision {
 namespace xpluginflow {
+/**
+ * how the bus spreads messages over its dispatcher threads, the messages of
+ * one type always reach a subscriber in push order
+ */
+enum class XDispatchMode {
+  // the subscribers of a type are called one by one on the thread of the type
+  BY_TYPE,
+  // every (type, subscriber) pair is bound to a thread, a slow OnMsg only
+  // delays the messages of its own subscriber. A plugin subscribing several
+  // types may then get OnMsg called concurrently from different threads
+  BY_SUBSCRIBER
+};
+
 class XMsgQueue : public hobot::CSingleton<XMsgQueue> {
  public:
-  XMsgQueue() {
-    msg_handle_.CreatThread(1);
-  }
+  XMsgQueue()
+      : table_(std::make_shared<SubscriberTable>()),
+        lanes_(MakeLanes(1, XDispatchMode::BY_TYPE)) {}
   ~XMsgQueue() = default;
 
  public:
+  /**
+   * set the dispatcher threads, one thread by default. Call it before the
+   * plugins start, the bus can not be reconfigured once a message is pushed
+   */
+  int SetDispatchThreads(int thread_num,
+                         XDispatchMode mode = XDispatchMode::BY_TYPE) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (pushed_) {
+      LOGE << "can not set dispatch threads after messages are pushed";
+      return -1;
+    }
+    if (thread_num < 1) {
+      LOGE << "invalid dispatch thread num: " << thread_num;
+      return -1;
+    }
+    // a push racing with this call may still post to the old lanes, they
+    // keep running until the bus is destroyed
+    retired_lanes_.push_back(std::atomic_load(&lanes_));
+    std::atomic_store(&lanes_, MakeLanes(thread_num, mode));
+    LOGD << "set xmsgqueue dispatch thread num = " << thread_num;
+    return 0;
+  }
+
   void RegisterPlugin(const XPluginPtr &plugin, const std::string& msg_type) {
     std::lock_guard<std::mutex> lck(mutex_);
     auto type_handle = XPluginMsgRegistry::Instance().Get(msg_type);
     HOBOT_CHECK(type_handle != XPLUGIN_INVALID_MSG_TYPE)
       << "try to register invalid msg type:" << msg_type
       << ", for plugin " << plugin->desc();
-    table_[type_handle].push_back(plugin);
+    auto table = std::make_shared<SubscriberTable>(*std::atomic_load(&table_));
+    if (table->size() <= static_cast<size_t>(type_handle)) {
+      table->resize(type_handle + 1);
+    }
+    if (next_slot_.size() <= static_cast<size_t>(type_handle)) {
+      next_slot_.resize(type_handle + 1, 0);
+    }
+    (*table)[type_handle].push_back({plugin, next_slot_[type_handle]++});
+    std::atomic_store(&table_,
+                      std::shared_ptr<const SubscriberTable>(table));
   }
   void UnRegisterPlugin(const XPluginPtr &plugin, const std::string& type) {
     std::lock_guard<std::mutex> lck(mutex_);
-    // todo
+    auto type_handle = XPluginMsgRegistry::Instance().Get(type);
+    auto current = std::atomic_load(&table_);
+    if (type_handle == XPLUGIN_INVALID_MSG_TYPE
+        || current->size() <= static_cast<size_t>(type_handle)) {
+      return;
+    }
+    auto table = std::make_shared<SubscriberTable>(*current);
+    auto &plugins = (*table)[type_handle];
+    plugins.erase(std::remove_if(plugins.begin(), plugins.end(),
+                                 [&plugin](const Subscriber &subscriber) {
+                                   return subscriber.plugin == plugin;
+                                 }),
+                  plugins.end());
+    std::atomic_store(&table_,
+                      std::shared_ptr<const SubscriberTable>(table));
   }
 
   void PushMsg(XPluginFlowMessagePtr msg) {
-    msg_handle_.PostTask(std::bind(&XMsgQueue::Dispatch, this, msg));
+    pushed_ = true;
+    // resolve the type handle on the producer side, once per message
+    auto type_handle = msg->type_handle();
+    // control messages overtake the data messages queued on their lane
+    int priority = static_cast<int>(msg->priority());
+    auto lanes = std::atomic_load(&lanes_);
+    auto &pools = lanes->pools;
+    if (pools.size() == 1 || lanes->mode == XDispatchMode::BY_TYPE
+        || type_handle == XPLUGIN_INVALID_MSG_TYPE) {
+      pools[LaneOf(pools, type_handle, 0)]->PostTask(
+          std::bind(&XMsgQueue::Dispatch, this, msg), priority);
+      return;
+    }
+    auto table = std::atomic_load(&table_);
+    if (table->size() <= static_cast<size_t>(type_handle)) {
+      return;
+    }
+    for (auto &subscriber : (*table)[type_handle]) {
+      // a subscriber always lands on the same lane for a given type
+      XPluginPtr plugin = subscriber.plugin;
+      pools[LaneOf(pools, type_handle, subscriber.slot)]->PostTask(
+          [plugin, msg]() {
+            plugin->OnMsg(msg);
+          }, priority);
+    }
   }
 
  private:
+  struct Subscriber {
+    XPluginPtr plugin;
+    // registration order within the type, the subscribers of a type are
+    // spread over consecutive lanes
+    uint32_t slot;
+  };
+  // subscribers indexed by message type handle
+  typedef std::vector<std::vector<Subscriber>> SubscriberTable;
+  typedef std::vector<std::unique_ptr<hobot::CThreadPool>> LanePools;
+  // single thread pools, each one keeps the order of its messages
+  struct Lanes {
+    XDispatchMode mode;
+    LanePools pools;
+  };
+
+  static std::shared_ptr<const Lanes> MakeLanes(int thread_num,
+                                                XDispatchMode mode) {
+    auto lanes = std::make_shared<Lanes>();
+    lanes->mode = mode;
+    for (int i = 0; i < thread_num; i++) {
+      lanes->pools.emplace_back(new hobot::CThreadPool());
+      lanes->pools.back()->CreatThread(1);
+    }
+    return lanes;
+  }
+
+  static size_t LaneOf(const LanePools &pools,
+                       XPluginMsgTypeHandle type_handle, uint32_t slot) {
+    return (static_cast<uint32_t>(type_handle) + slot) % pools.size();
+  }
+
   void Dispatch(XPluginFlowMessagePtr msg) {
-    std::lock_guard<std::mutex> lck(mutex_);
-    auto type_handle = XPluginMsgRegistry::Instance().Get(msg->type());
+    auto type_handle = msg->type_handle();
     if (type_handle == XPLUGIN_INVALID_MSG_TYPE) {
       LOGW << "push no consumer message，type:" << msg->type();
       return;
     }
-    auto &plugins = table_[type_handle];
-    for (auto &plugin : plugins) {
-      plugin->OnMsg(msg);
+    // copy-on-write table, a plugin unregistered during the dispatch may
+    // still receive this message
+    auto table = std::atomic_load(&table_);
+    if (table->size() <= static_cast<size_t>(type_handle)) {
+      return;
+    }
+    for (auto &subscriber : (*table)[type_handle]) {
+      subscriber.plugin->OnMsg(msg);
     }
   }
 
  private:
-  std::map<XPluginMsgTypeHandle, std::vector<XPluginPtr>> table_;
-  hobot::CThreadPool msg_handle_;
+  std::shared_ptr<const SubscriberTable> table_;
+  // replaced as a whole by SetDispatchThreads, read without lock by PushMsg
+  std::shared_ptr<const Lanes> lanes_;
+  std::atomic<bool> pushed_{false};
 
+  // serializes the writers of table_ and lanes_
   std::mutex mutex_;
+  // lanes replaced by SetDispatchThreads, guarded by mutex_
+  std::vector<std::shared_ptr<const Lanes>> retired_lanes_;
+  // next subscriber slot of each type, guarded by mutex_
+  std::vector<uint32_t> next_slot_;
 };
 
 }  // namespace xpluginflow
@@ -16,6 +16,8 @@
 #ifndef XPLUGINFLOW_INCLUDE_XPLUGINFLOW_MESSAGE_PLUGINFLOW_FLOWMSG_H_
 #define XPLUGINFLOW_INCLUDE_XPLUGINFLOW_MESSAGE_PLUGINFLOW_FLOWMSG_H_
 #include <memory>
+#include <string>
+#include "xpluginflow/message/pluginflow/msg_registry.h"
 namespace horizon {
 namespace vision {
 namespace xpluginflow {
@@ -40,11 +42,46 @@ struct XPluginFlowMessage
 
   std::string param_ = "";
 
-  std::string type() const {
+  const std::string &type() const {
     return type_;
   }
 
+  // handle of type_ in XPluginMsgRegistry, resolved once when the message is
+  // pushed to the bus; type_ must not change after that
+  XPluginMsgTypeHandle type_handle() const {
+    if (type_handle_ == XPLUGIN_UNRESOLVED_MSG_TYPE) {
+      auto &registry = XPluginMsgRegistry::Instance();
+      auto handle = registry.Get(type_);
+      priority_ = registry.GetPriority(handle);
+      type_handle_ = handle;
+    }
+    return type_handle_;
+  }
+
+  // priority class of type_, resolved together with type_handle()
+  XMsgPriority priority() const {
+    type_handle();
+    return priority_;
+  }
+
   virtual std::string Serialize() = 0;
+
+  // result of Serialize(), computed by the first caller and then shared by
+  // every consumer of the message; the message must not change after that
+  std::shared_ptr<const std::string> SerializedData() {
+    auto data = std::atomic_load(&serialized_);
+    if (!data) {
+      // concurrent first callers may both serialize, the results are equal
+      data = std::make_shared<const std::string>(Serialize());
+      std::atomic_store(&serialized_, data);
+    }
+    return data;
+  }
+
+ private:
+  std::shared_ptr<const std::string> serialized_;
+  mutable XPluginMsgTypeHandle type_handle_ = XPLUGIN_UNRESOLVED_MSG_TYPE;
+  mutable XMsgPriority priority_ = XMsgPriority::DATA;
 };
 
 using XPluginFlowMessagePtr = std::shared_ptr<XPluginFlowMessage>;
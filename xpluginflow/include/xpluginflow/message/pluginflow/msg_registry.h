@@ -19,6 +19,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "hobotlog/hobotlog.hpp"
 
 namespace horizon {
@@ -26,26 +27,58 @@ namespace vision {
 namespace xpluginflow {
 typedef int32_t XPluginMsgTypeHandle;
 #define XPLUGIN_INVALID_MSG_TYPE -1
+#define XPLUGIN_UNRESOLVED_MSG_TYPE -2
+
+/**
+ * priority class of a message type, the bus and the plugin threads always
+ * take the queued messages of a higher class first
+ */
+enum class XMsgPriority {
+  // images, smart results
+  DATA = 0,
+  // configuration updates, drop notifications
+  CONTROL = 1
+};
+
 class XPluginMsgRegistry {
  public:
   inline XPluginMsgTypeHandle RegisterOrGet(const std::string& name) {
     std::lock_guard<std::mutex> lck(mutex_);
     if (fmap_.count(name) == 0) {
-      fmap_[name] = counter_++;
-      return fmap_[name];
+      return Add(name, XMsgPriority::DATA);
     } else {
       return fmap_.at(name);
     }
   }
 
-  inline XPluginMsgTypeHandle Register(const std::string& name) {
+  inline XPluginMsgTypeHandle Register(
+      const std::string& name, XMsgPriority priority = XMsgPriority::DATA) {
     std::lock_guard<std::mutex> lck(mutex_);
     if (fmap_.count(name)) {
       LOGF << "XPlugin msg type:" << name << " already registered!";
       return XPLUGIN_INVALID_MSG_TYPE;
     }
-    fmap_[name] = counter_++;
-    return fmap_[name];
+    return Add(name, priority);
+  }
+
+  // change the priority of a registered type, before its messages are pushed
+  inline int SetPriority(const std::string& name, XMsgPriority priority) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    auto iter = fmap_.find(name);
+    if (iter == fmap_.end()) {
+      LOGE << "XPlugin msg type:" << name << " not registered";
+      return -1;
+    }
+    priority_[iter->second] = priority;
+    return 0;
+  }
+
+  inline XMsgPriority GetPriority(XPluginMsgTypeHandle handle) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (handle < 0 || static_cast<size_t>(handle) >= priority_.size()) {
+      return XMsgPriority::DATA;
+    }
+    return priority_[handle];
   }
 
   inline XPluginMsgTypeHandle Get(const std::string& name) {
@@ -64,8 +97,16 @@ class XPluginMsgRegistry {
  private:
   std::mutex mutex_;
   std::map<std::string, XPluginMsgTypeHandle> fmap_;
+  // indexed by type handle
+  std::vector<XMsgPriority> priority_;
   int32_t counter_{0};
 
+  XPluginMsgTypeHandle Add(const std::string& name, XMsgPriority priority) {
+    fmap_[name] = counter_++;
+    priority_.push_back(priority);
+    return fmap_[name];
+  }
+
   XPluginMsgRegistry() {}
   ~XPluginMsgRegistry() {}
 };
@@ -75,6 +116,13 @@ static horizon::vision::xpluginflow::XPluginMsgTypeHandle   \
   __make__##key##__xplugin_msg_type__ =                     \
   horizon::vision::xpluginflow::XPluginMsgRegistry::Instance().Register(#key);
 
+// register a message type of the CONTROL priority class
+#define XPLUGIN_REGISTER_CONTROL_MSG_TYPE(key)              \
+static horizon::vision::xpluginflow::XPluginMsgTypeHandle   \
+  __make__##key##__xplugin_msg_type__ =                     \
+  horizon::vision::xpluginflow::XPluginMsgRegistry::Instance().Register( \
+    #key, horizon::vision::xpluginflow::XMsgPriority::CONTROL);
+
 }  // namespace xpluginflow
 }  // namespace vision
 }  // namespace horizon
@@ -17,7 +17,12 @@
 
 #ifndef INCLUDE_XPLUGINFLOW_PLUGIN_XPLUGINASYNC_H_
 #define INCLUDE_XPLUGINFLOW_PLUGIN_XPLUGINASYNC_H_
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include "xpluginflow/plugin/xplugin.h"
 #include "xpluginflow/message/pluginflow/flowmsg.h"
@@ -26,6 +31,39 @@ namespace horizon {
 namespace vision {
 namespace xpluginflow {
 
+/*
+ * \Desc 每种消息类型的本地队列满时的处理策略
+ */
+enum class XMsgQueuePolicy {
+  // 丢弃新到的消息
+  DROP_NEWEST,
+  // 丢弃队列中最早的消息
+  DROP_OLDEST,
+  // 阻塞推送线程直到队列有空位，超时后丢弃新到的消息。
+  // 推送线程是总线分发线程，只应在独占的分发线程上使用
+  BLOCK,
+  // 新到的消息替换队列中最后一个消息
+  COALESCE
+};
+
+struct XMsgQueueConfig {
+  size_t capacity = 30;
+  XMsgQueuePolicy policy = XMsgQueuePolicy::DROP_NEWEST;
+  // BLOCK策略的最长等待时间
+  int block_timeout_ms = 100;
+};
+
+struct XMsgQueueStats {
+  size_t capacity = 0;
+  // 当前排队的消息数及历史峰值
+  size_t size = 0;
+  size_t peak_size = 0;
+  uint64_t received = 0;
+  uint64_t processed = 0;
+  // 被丢弃或被替换的消息数
+  uint64_t dropped = 0;
+};
+
 /*
  * \Desc Plugin实现
  *       消息处理包含上半部分和下半部分：
@@ -49,6 +87,11 @@ class XPluginAsync : public XPlugin {
   virtual int Stop() {
     return 0;
   }
+  // 修改已注册消息类型的队列容量与策略
+  void SetMsgQueueConfig(const std::string& type,
+                         const XMsgQueueConfig& config);
+  // 获取已注册消息类型的队列统计信息
+  XMsgQueueStats GetMsgQueueStats(const std::string& type);
 
  protected:
   using XPluginFlowMessageFunc = std::function<int(XPluginFlowMessagePtr)>;
@@ -57,13 +100,26 @@ class XPluginAsync : public XPlugin {
   // Note: 自定义的plugin需要在Init函数中，
   //       调用XPluginAsync::Init之前调用该接口完成监听消息注册。
   void RegisterMsg(const std::string& type, XPluginFlowMessageFunc callback);
+  void RegisterMsg(const std::string& type, XPluginFlowMessageFunc callback,
+                   const XMsgQueueConfig& config);
 
  private:
-  // 消息处理下半部分，分发消息并调用对应的callback函数
-  void OnMsgDown(XPluginFlowMessagePtr msg);
+  struct MsgQueue {
+    XPluginFlowMessageFunc callback;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    XMsgQueueConfig config;
+    std::deque<XPluginFlowMessagePtr> msgs;
+    XMsgQueueStats stats;
+  };
+  // 消息处理下半部分，取出队列头部的消息并调用对应的callback函数
+  void OnMsgDown(MsgQueue *queue);
+
+  std::shared_ptr<MsgQueue> FindQueue(const std::string& type);
 
+  // 注册完成后只读, 需在msg_handle_之后析构
+  std::map<std::string, std::shared_ptr<MsgQueue>> msg_map_;
   hobot::CThreadPool msg_handle_;
-  std::map<std::string, XPluginFlowMessageFunc> msg_map_;
 };
 
 }  // namespace xpluginflow
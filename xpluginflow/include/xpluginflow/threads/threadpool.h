@@ -24,11 +24,16 @@ struct Task {
 
 class CThreadPool {
  public:
+  // tasks of a higher priority are always taken first, FIFO within a priority
+  static const int kPriorityNum = 4;
+
   CThreadPool();
   virtual ~CThreadPool();
   void CreatThread(int threadCount);
   // post an async task
   void PostTask(const TaskFunction &task);
+  // post an async task of priority in [0, kPriorityNum), 0 is the lowest
+  void PostTask(const TaskFunction &task, int priority);
   int GetTaskNum();
   void ClearTask();
   // void PostPollingTask(const TaskFunction& task);
@@ -40,7 +45,9 @@ class CThreadPool {
 
  private:
   typedef std::list<std::shared_ptr<Task> > TaskContainer;
-  TaskContainer m_setTaskQuenes;
+  // one queue per priority
+  TaskContainer m_setTaskQuenes[kPriorityNum];
+  int m_nTaskNum;
   mutable std::mutex m_mutThread;
   // a mutex for task quene operations only
   mutable std::mutex m_mutTaskQuene;
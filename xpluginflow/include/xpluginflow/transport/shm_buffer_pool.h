@@ -0,0 +1,138 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_buffer_pool.h
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    reference counted buffer pool placed in shared memory
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+
+#ifndef INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_BUFFER_POOL_H_
+#define INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_BUFFER_POOL_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+class ShmBufferPool;
+
+/**
+ * counted reference to a block of a ShmBufferPool, the block returns to the
+ * pool when the last reference of all processes is released
+ */
+class ShmBuffer {
+ public:
+  ShmBuffer() = default;
+  ShmBuffer(const ShmBuffer &other);
+  ShmBuffer(ShmBuffer &&other);
+  ShmBuffer &operator=(ShmBuffer other);
+  ~ShmBuffer();
+
+  explicit operator bool() const { return data_ != nullptr; }
+  uint8_t *data() const { return data_; }
+  // capacity of the block
+  uint32_t size() const;
+  uint32_t index() const { return index_; }
+
+ private:
+  friend class ShmBufferPool;
+  ShmBuffer(std::shared_ptr<ShmBufferPool> pool, uint32_t index);
+
+  std::shared_ptr<ShmBufferPool> pool_;
+  uint32_t index_ = 0;
+  uint8_t *data_ = nullptr;
+};
+
+/**
+ * fixed number of fixed size blocks with reference counts per block, all
+ * in one shared memory block. Allocation takes a free block with a CAS on
+ * its counts, no lock is shared between the processes.
+ * The references of a block are counted separately for the creator (side
+ * 0), the process that attached (side 1) and the handed over references
+ * not adopted yet, so that the references of a crashed process can be
+ * reclaimed by the other one.
+ */
+class ShmBufferPool : public std::enable_shared_from_this<ShmBufferPool> {
+ public:
+  static size_t Size(uint32_t block_num, uint32_t block_size);
+
+  // format the memory, by the creator of the shared memory only. owner keeps
+  // the memory mapped while a buffer of the pool is alive
+  void Init(void *mem, uint32_t block_num, uint32_t block_size,
+            std::shared_ptr<void> owner = nullptr);
+  // false if the memory does not hold a pool
+  bool Attach(void *mem, std::shared_ptr<void> owner = nullptr);
+
+  // an empty buffer if all blocks are in use
+  ShmBuffer Allocate();
+  // take over a reference added by Handover, usually in another process.
+  // An empty buffer if index holds no handed over reference
+  ShmBuffer Adopt(uint32_t index);
+  // add a reference to be adopted on the other side, returns its index
+  uint32_t Handover(const ShmBuffer &buffer);
+  // drop a reference that was handed over but will never be adopted
+  void Revoke(uint32_t index);
+  // drop the references of side, whose process is gone, and all handed over
+  // references. Returns the number of dropped references
+  uint32_t Reclaim(uint32_t side);
+  // drop all handed over references, when the records carrying them were
+  // dropped. Returns the number of dropped references
+  uint32_t RevokeAll();
+
+  // 0 for the creator, 1 for the process that attached
+  uint32_t side() const { return side_; }
+  bool Owns(const ShmBuffer &buffer) const {
+    return buffer.pool_.get() == this;
+  }
+  uint32_t block_num() const { return header_->block_num; }
+  uint32_t block_size() const { return header_->block_size; }
+  uint32_t FreeCount() const;
+
+ private:
+  friend class ShmBuffer;
+  struct Header {
+    uint32_t magic;
+    uint32_t block_num;
+    uint32_t block_size;
+    uint32_t block_offset;
+  };
+
+  // bits of one count in the reference state of a block
+  static const uint32_t kCountBits = 21;
+  // count of the handed over references, after the counts of side 0 and 1
+  static const uint32_t kHandover = 2;
+  static uint64_t Unit(uint32_t field) {
+    return 1ull << (field * kCountBits);
+  }
+  static uint64_t Mask(uint32_t field) {
+    return ((1ull << kCountBits) - 1) << (field * kCountBits);
+  }
+
+  std::atomic<uint64_t> *RefCount(uint32_t index) const;
+  uint8_t *Block(uint32_t index) const;
+  void AddRef(uint32_t index);
+  void Release(uint32_t index);
+  // clear the count fields of mask in all blocks
+  uint32_t Drop(uint64_t mask);
+
+  Header *header_ = nullptr;
+  std::shared_ptr<void> owner_;
+  uint32_t side_ = 0;
+  // allocation scan starts after the last allocated block
+  std::atomic<uint32_t> next_{0};
+};
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
+#endif  // INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_BUFFER_POOL_H_
@@ -0,0 +1,62 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_region.h
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    named posix shared memory region
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+
+#ifndef INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_REGION_H_
+#define INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_REGION_H_
+#include <cstddef>
+#include <string>
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+/**
+ * a named shared memory region mapped into this process. The creator owns
+ * the name and unlinks it when destroyed, processes that opened it keep
+ * their mapping until they close it. The descriptor stays open while mapped,
+ * so that an opener can see its region was unlinked by a restarted creator.
+ */
+class ShmRegion {
+ public:
+  ShmRegion() = default;
+  ~ShmRegion();
+  ShmRegion(const ShmRegion &) = delete;
+  ShmRegion &operator=(const ShmRegion &) = delete;
+
+  // create the region, an existing region of the same name is replaced
+  int Create(const std::string &name, size_t size);
+  // map a region created by another process
+  int Open(const std::string &name);
+  void Close();
+  // true once the name no longer refers to this region, the creator is gone
+  // or replaced the region by a new one
+  bool Unlinked() const;
+
+  void *data() const { return data_; }
+  size_t size() const { return size_; }
+  const std::string &name() const { return name_; }
+
+ private:
+  std::string name_;
+  int fd_ = -1;
+  void *data_ = nullptr;
+  size_t size_ = 0;
+  bool owner_ = false;
+};
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
+#endif  // INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_REGION_H_
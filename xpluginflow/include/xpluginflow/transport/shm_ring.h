@@ -0,0 +1,162 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_ring.h
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    lock-free record ring placed in shared memory
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+
+#ifndef INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_RING_H_
+#define INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_RING_H_
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+/**
+ * single producer / single consumer ring of variable length records over a
+ * caller provided memory block, usable across processes. head and tail are
+ * byte positions that only grow, each record is a 8 byte length header
+ * followed by the payload padded to 8 bytes. A record never wraps, the
+ * producer skips the end of the buffer with a wrap marker instead.
+ */
+class ShmRing {
+ public:
+  // bytes of memory needed for a ring of capacity bytes
+  static size_t Size(size_t capacity) {
+    return sizeof(Header) + Align(capacity);
+  }
+
+  // format the memory, by the creator of the shared memory only
+  void Init(void *mem, size_t capacity) {
+    header_ = new (mem) Header();
+    header_->head.store(0, std::memory_order_relaxed);
+    header_->tail.store(0, std::memory_order_relaxed);
+    header_->capacity = Align(capacity);
+    data_ = reinterpret_cast<uint8_t *>(header_ + 1);
+  }
+
+  void Attach(void *mem) {
+    header_ = reinterpret_cast<Header *>(mem);
+    data_ = reinterpret_cast<uint8_t *>(header_ + 1);
+  }
+
+  // largest payload a record can hold
+  size_t MaxRecord() const {
+    return header_->capacity / 2 - kRecordHeader;
+  }
+
+  // false if the ring is full or the record too large
+  bool TryPush(const void *data, size_t len) {
+    if (len > MaxRecord()) {
+      return false;
+    }
+    uint64_t capacity = header_->capacity;
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    uint64_t offset = head % capacity;
+    uint64_t need = kRecordHeader + Align(len);
+    uint64_t skip = (capacity - offset < need) ? capacity - offset : 0;
+    if (head + skip + need - tail > capacity) {
+      return false;
+    }
+    if (skip > 0) {
+      SetLength(offset, kWrapMarker);
+      head += skip;
+      offset = 0;
+    }
+    SetLength(offset, static_cast<uint64_t>(len));
+    memcpy(data_ + offset + kRecordHeader, data, len);
+    header_->head.store(head + need, std::memory_order_release);
+    return true;
+  }
+
+  // false if the ring is empty. A record header written wrong by the other
+  // side drops all pending records and sets corrupted
+  bool TryPop(std::string *record, bool *corrupted = nullptr) {
+    uint64_t capacity = header_->capacity;
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    if (corrupted) {
+      *corrupted = false;
+    }
+    if (tail == head) {
+      return false;
+    }
+    uint64_t offset = tail % capacity;
+    uint64_t len = GetLength(offset);
+    if (len == kWrapMarker) {
+      tail += capacity - offset;
+      offset = 0;
+      len = GetLength(offset);
+    }
+    if (head - tail > capacity || len > capacity - offset - kRecordHeader
+        || kRecordHeader + Align(len) > head - tail) {
+      header_->tail.store(head, std::memory_order_release);
+      if (corrupted) {
+        *corrupted = true;
+      }
+      return false;
+    }
+    record->assign(reinterpret_cast<const char *>(data_ + offset
+                                                  + kRecordHeader), len);
+    header_->tail.store(tail + kRecordHeader + Align(len),
+                        std::memory_order_release);
+    return true;
+  }
+
+  // drop all pending records, by the consumer or, when the consumer is gone,
+  // by the producer
+  void Reset() {
+    header_->tail.store(header_->head.load(std::memory_order_acquire),
+                        std::memory_order_release);
+  }
+
+  bool Empty() const {
+    return header_->tail.load(std::memory_order_acquire)
+        == header_->head.load(std::memory_order_acquire);
+  }
+
+ private:
+  static const uint64_t kRecordHeader = 8;
+  static const uint64_t kWrapMarker = ~0ull;
+
+  struct Header {
+    // head and tail on their own cache lines, written by different sides
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) uint64_t capacity;
+  };
+
+  static uint64_t Align(uint64_t len) {
+    return (len + 7) & ~static_cast<uint64_t>(7);
+  }
+  void SetLength(uint64_t offset, uint64_t len) {
+    memcpy(data_ + offset, &len, sizeof(len));
+  }
+  uint64_t GetLength(uint64_t offset) const {
+    uint64_t len;
+    memcpy(&len, data_ + offset, sizeof(len));
+    return len;
+  }
+
+  Header *header_ = nullptr;
+  uint8_t *data_ = nullptr;
+};
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
+#endif  // INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_RING_H_
@@ -0,0 +1,257 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_transport.h
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    bridge of the message bus between processes of one board
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+
+#ifndef INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_TRANSPORT_H_
+#define INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_TRANSPORT_H_
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "xpluginflow/message/pluginflow/flowmsg.h"
+#include "xpluginflow/plugin/xplugin.h"
+#include "xpluginflow/transport/shm_buffer_pool.h"
+#include "xpluginflow/transport/shm_region.h"
+#include "xpluginflow/transport/shm_ring.h"
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+// encoded message fields, with references to shared buffers for the payloads
+class ShmWriter {
+ public:
+  void Write(const void *data, size_t len) {
+    payload_.append(reinterpret_cast<const char *>(data), len);
+  }
+  template <typename T>
+  void Put(const T &value) {
+    Write(&value, sizeof(T));
+  }
+  void PutString(const std::string &value) {
+    Put(static_cast<uint32_t>(value.size()));
+    Write(value.data(), value.size());
+  }
+  // the buffers are read back by ShmReader::GetBuffer in the same order
+  void PutBuffer(const ShmBuffer &buffer) { buffers_.push_back(buffer); }
+
+ private:
+  friend class XShmChannel;
+  std::string payload_;
+  std::vector<ShmBuffer> buffers_;
+};
+
+class ShmReader {
+ public:
+  bool Read(void *data, size_t len) {
+    if (payload_.size() - pos_ < len) {
+      return false;
+    }
+    payload_.copy(reinterpret_cast<char *>(data), len, pos_);
+    pos_ += len;
+    return true;
+  }
+  template <typename T>
+  bool Get(T *value) {
+    return Read(value, sizeof(T));
+  }
+  bool GetString(std::string *value) {
+    uint32_t len;
+    if (!Get(&len) || payload_.size() - pos_ < len) {
+      return false;
+    }
+    value->assign(payload_, pos_, len);
+    pos_ += len;
+    return true;
+  }
+  bool GetBuffer(ShmBuffer *buffer) {
+    if (buffer_pos_ >= buffers_.size()) {
+      return false;
+    }
+    *buffer = buffers_[buffer_pos_++];
+    return true;
+  }
+
+ private:
+  friend class XShmChannel;
+  std::string payload_;
+  size_t pos_ = 0;
+  std::vector<ShmBuffer> buffers_;
+  size_t buffer_pos_ = 0;
+};
+
+/**
+ * how a message type crosses the process boundary. Both processes register
+ * the same codec for the type. Large payloads should live in buffers of the
+ * channel (XShmChannel::AllocBuffer) so that only their reference is copied.
+ */
+struct XShmCodec {
+  std::function<bool(const XPluginFlowMessagePtr &msg, ShmWriter *writer)>
+      encode;
+  std::function<XPluginFlowMessagePtr(ShmReader *reader)> decode;
+};
+
+class XShmCodecRegistry {
+ public:
+  static XShmCodecRegistry &Instance() {
+    static XShmCodecRegistry inst;
+    return inst;
+  }
+  void Register(const std::string &type, const XShmCodec &codec) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    codecs_[type] = std::make_shared<XShmCodec>(codec);
+  }
+  std::shared_ptr<const XShmCodec> Get(const std::string &type) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    auto iter = codecs_.find(type);
+    return iter == codecs_.end() ? nullptr : iter->second;
+  }
+
+ private:
+  XShmCodecRegistry() = default;
+  std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<const XShmCodec>> codecs_;
+};
+
+struct XShmChannelConfig {
+  // bytes of the message ring
+  size_t ring_bytes = 1 << 20;
+  // payload buffers, one nv12 1080p frame each by default
+  uint32_t block_num = 8;
+  uint32_t block_size = 1920 * 1080 * 3 / 2;
+};
+
+/**
+ * one way channel in a named shared memory region: a lock-free ring of
+ * encoded messages plus a buffer pool for their payloads. One process
+ * creates it, the other opens it; there is one sending and one receiving
+ * thread at a time.
+ * The region records the pid of both processes. When one of them is found
+ * dead by CheckPeer, the other drops the pending messages and reclaims the
+ * buffers the dead process held, then a new process can open the channel.
+ * A restarted creator replaces the region, CheckPeer of the process that
+ * opened the old one then opens the new one.
+ */
+class XShmChannel {
+ public:
+  ~XShmChannel();
+  int Create(const std::string &name,
+             const XShmChannelConfig &config = XShmChannelConfig());
+  // fails while another process has the channel open, or while the buffers
+  // of a previous one that died are not reclaimed yet
+  int Open(const std::string &name);
+
+  // an empty buffer if all blocks are in use
+  ShmBuffer AllocBuffer();
+  // false if the ring is full or a buffer is of a replaced region, the
+  // buffers are then not handed over
+  bool Send(const std::string &type, const ShmWriter &writer);
+  // 1 with a message, 0 if there is none, -1 on a corrupted record; the
+  // pending records are then dropped
+  int Receive(std::string *type, ShmReader *reader);
+  // false if the other process died and its buffers were reclaimed, or if
+  // the channel was opened again on the region of a restarted creator.
+  // Called from the sending or the receiving thread
+  bool CheckPeer();
+
+  const std::shared_ptr<ShmBufferPool> &pool() const { return pool_; }
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t pool_offset;
+    // pid of the creator and of the process that opened the channel, 0 if
+    // there is none, kRecovering while its buffers are reclaimed
+    std::atomic<int32_t> pid[2];
+  };
+  Header *header() const {
+    return reinterpret_cast<Header *>(region_->data());
+  }
+  // open the region that replaced the unlinked one, false until the creator
+  // has made it
+  bool Reopen();
+
+  std::shared_ptr<ShmRegion> region_;
+  ShmRing ring_;
+  std::shared_ptr<ShmBufferPool> pool_;
+  // reused record memory
+  std::string send_record_;
+  std::string recv_record_;
+};
+
+/**
+ * forwards the messages of the given types from the local bus to a channel,
+ * using their XShmCodec. Messages are never serialized with Serialize(),
+ * that is left to the plugins sending them off the board.
+ */
+class XShmSender : public XPlugin {
+ public:
+  XShmSender(std::shared_ptr<XShmChannel> channel,
+             const std::vector<std::string> &types)
+      : channel_(channel), types_(types) {}
+  int Init() override;
+  void OnMsg(XPluginFlowMessagePtr msg) override;
+  std::string desc() const override { return "XShmSender"; }
+
+  uint64_t sent() const { return sent_; }
+  // messages without codec, failed to encode or dropped on a full ring
+  uint64_t dropped() const { return dropped_; }
+
+ private:
+  std::shared_ptr<XShmChannel> channel_;
+  std::vector<std::string> types_;
+  // the bus may call OnMsg from several lanes, the ring has one producer
+  std::mutex mutex_;
+  std::chrono::steady_clock::time_point last_check_;
+  std::atomic<uint64_t> sent_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * polls a channel on its own thread and pushes the decoded messages to the
+ * local bus
+ */
+class XShmReceiver : public XPlugin {
+ public:
+  explicit XShmReceiver(std::shared_ptr<XShmChannel> channel)
+      : channel_(channel) {}
+  ~XShmReceiver() override { Stop(); }
+  int Init() override { return 0; }
+  void OnMsg(XPluginFlowMessagePtr msg) override {}
+  std::string desc() const override { return "XShmReceiver"; }
+  int Start();
+  int Stop();
+
+  uint64_t received() const { return received_; }
+
+ private:
+  void Loop();
+
+  std::shared_ptr<XShmChannel> channel_;
+  std::thread thread_;
+  std::atomic<bool> stop_{true};
+  std::atomic<uint64_t> received_{0};
+};
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
+#endif  // INCLUDE_XPLUGINFLOW_TRANSPORT_SHM_TRANSPORT_H_
@@ -26,8 +26,7 @@ void XPlugin::RegisterMsg(const std::string& type) {
 
 
 void XPlugin::UnRegisterMsg(const std::string& type) {
-  // todo
-  // 实现取消注册消息类型
+  XMsgQueue::Instance().UnRegisterPlugin(shared_from_this(), type);
 }
 
 void XPlugin::PushMsg(XPluginFlowMessagePtr msg) {
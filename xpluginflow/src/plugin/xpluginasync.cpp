@@ -14,6 +14,8 @@
  * \WHICH IS AUTO GENERATED BY EDITOR
  * -------------------------------------------
  */
+#include <algorithm>
+#include <chrono>
 #include "xpluginflow/plugin/xplugin.h"
 #include "hobotlog/hobotlog.hpp"
 #include "xpluginflow/manager/msg_manager.h"
@@ -32,25 +34,121 @@ int XPluginAsync::Init() {
 
 void XPluginAsync::RegisterMsg(const std::string& type,
                                XPluginFlowMessageFunc callback) {
+  RegisterMsg(type, callback, XMsgQueueConfig());
+}
+
+void XPluginAsync::RegisterMsg(const std::string& type,
+                               XPluginFlowMessageFunc callback,
+                               const XMsgQueueConfig& config) {
   HOBOT_CHECK(msg_map_.count(type) == 0)
     << "type:" << type << " already registered.";
-  msg_map_[type] = callback;
+  auto queue = std::make_shared<MsgQueue>();
+  queue->callback = callback;
+  queue->config = config;
+  queue->stats.capacity = config.capacity;
+  msg_map_[type] = queue;
+}
+
+void XPluginAsync::SetMsgQueueConfig(const std::string& type,
+                                     const XMsgQueueConfig& config) {
+  auto queue = FindQueue(type);
+  std::lock_guard<std::mutex> lck(queue->mutex);
+  queue->config = config;
+  queue->stats.capacity = config.capacity;
+  queue->not_full.notify_all();
+}
+
+XMsgQueueStats XPluginAsync::GetMsgQueueStats(const std::string& type) {
+  auto queue = FindQueue(type);
+  std::lock_guard<std::mutex> lck(queue->mutex);
+  auto stats = queue->stats;
+  stats.size = queue->msgs.size();
+  return stats;
+}
+
+std::shared_ptr<XPluginAsync::MsgQueue> XPluginAsync::FindQueue(
+    const std::string& type) {
+  auto iter = msg_map_.find(type);
+  HOBOT_CHECK(iter != msg_map_.end())
+    << "No message type:" << type << " registered in " << desc();
+  return iter->second;
 }
 
 void XPluginAsync::OnMsg(XPluginFlowMessagePtr msg) {
-  // todo
-  // 实现消息队列和流量控制
-  if (msg_handle_.GetTaskNum() < 30) {
-    msg_handle_.PostTask(std::bind(&XPluginAsync::OnMsgDown, this, msg));
-  } else {
-    LOGI << "Task Max Size = 30";
+  auto queue = FindQueue(msg->type());
+  std::unique_lock<std::mutex> lck(queue->mutex);
+  auto &config = queue->config;
+  auto &stats = queue->stats;
+  stats.received++;
+  bool post = true;
+  if (queue->msgs.size() >= config.capacity) {
+    switch (config.policy) {
+      case XMsgQueuePolicy::DROP_NEWEST:
+        stats.dropped++;
+        LOGD << desc() << " drop newest " << msg->type()
+             << ", queue size = " << queue->msgs.size();
+        return;
+      case XMsgQueuePolicy::DROP_OLDEST:
+      case XMsgQueuePolicy::COALESCE:
+        // the message replaces a queued one, whose task will process it
+        stats.dropped++;
+        if (queue->msgs.empty()) {
+          return;
+        }
+        if (config.policy == XMsgQueuePolicy::DROP_OLDEST) {
+          queue->msgs.pop_front();
+          queue->msgs.push_back(msg);
+        } else {
+          queue->msgs.back() = msg;
+        }
+        return;
+      case XMsgQueuePolicy::BLOCK:
+        if (!queue->not_full.wait_for(
+                lck, std::chrono::milliseconds(config.block_timeout_ms),
+                [queue] {
+                  return queue->msgs.size() < queue->config.capacity;
+                })) {
+          stats.dropped++;
+          LOGW << desc() << " drop " << msg->type() << " after blocking "
+               << config.block_timeout_ms << "ms";
+          return;
+        }
+        break;
+    }
+  } else if (config.policy == XMsgQueuePolicy::COALESCE
+             && !queue->msgs.empty()) {
+    // only the latest message matters, keep one pending
+    stats.dropped++;
+    queue->msgs.back() = msg;
+    post = false;
+  }
+  if (post) {
+    queue->msgs.push_back(msg);
+    stats.peak_size = std::max(stats.peak_size, queue->msgs.size());
+  }
+  lck.unlock();
+  if (post) {
+    // each type has its own queue, so a control task overtaking the queued
+    // data tasks still takes the messages of its type in order
+    msg_handle_.PostTask(std::bind(&XPluginAsync::OnMsgDown, this,
+                                   queue.get()),
+                         static_cast<int>(msg->priority()));
   }
 }
 
-void XPluginAsync::OnMsgDown(XPluginFlowMessagePtr msg) {
-  HOBOT_CHECK(msg_map_.count(msg->type()))
-    << "No message type:" << msg->type() << " registered in " << desc();
-  msg_map_[msg->type()](msg);
+void XPluginAsync::OnMsgDown(MsgQueue *queue) {
+  XPluginFlowMessagePtr msg;
+  {
+    std::lock_guard<std::mutex> lck(queue->mutex);
+    if (queue->msgs.empty()) {
+      return;
+    }
+    msg = queue->msgs.front();
+    queue->msgs.pop_front();
+    queue->stats.processed++;
+  }
+  queue->not_full.notify_one();
+  queue->callback(msg);
 }
 
 XPluginAsync::XPluginAsync() {
@@ -3,9 +3,13 @@
 // Copyright (c) 2018 horizon robotics. All rights reserved.
 //
 #include "xpluginflow/threads/threadpool.h"
+#include <algorithm>
 #include "hobotlog/hobotlog.hpp"
 namespace hobot {
-CThreadPool::CThreadPool() { stop_ = false; }
+CThreadPool::CThreadPool() {
+  stop_ = false;
+  m_nTaskNum = 0;
+}
 
 CThreadPool::~CThreadPool() {
   {
@@ -43,15 +47,22 @@ void CThreadPool::exec_loop() {
     std::shared_ptr<Task> tsk;
     {
       std::unique_lock<std::mutex> lck(m_mutTaskQuene);
-      if (!stop_ && m_setTaskQuenes.size() <= 0) {
+      if (!stop_ && m_nTaskNum <= 0) {
         m_varCondition.wait(lck);
       }
 
-      if (stop_ || m_setTaskQuenes.size() <= 0) {
+      if (stop_ || m_nTaskNum <= 0) {
         continue;
       }
-      tsk = m_setTaskQuenes.front();
-      m_setTaskQuenes.pop_front();
+      for (int i = kPriorityNum - 1; i >= 0; --i) {
+        auto &quene = m_setTaskQuenes[i];
+        if (!quene.empty()) {
+          tsk = quene.front();
+          quene.pop_front();
+          break;
+        }
+      }
+      --m_nTaskNum;
     }
     //  Exec one task, wake other threads.
     tsk->func();
@@ -59,18 +70,30 @@ void CThreadPool::exec_loop() {
 }
 
 void CThreadPool::PostTask(const TaskFunction &fun) {
+  PostTask(fun, 0);
+}
+
+void CThreadPool::PostTask(const TaskFunction &fun, int priority) {
+  priority = std::max(0, std::min(priority, kPriorityNum - 1));
   {
     std::lock_guard<std::mutex> lck(m_mutTaskQuene);
     auto task = std::make_shared<Task>(fun);
-    m_setTaskQuenes.push_back(task);
+    m_setTaskQuenes[priority].push_back(task);
+    ++m_nTaskNum;
     m_varCondition.notify_one();  // wake worker thread(s)
   }
 }
 
 void CThreadPool::ClearTask() {
   std::lock_guard<std::mutex> lck(m_mutTaskQuene);
-  m_setTaskQuenes.clear();
+  for (auto &quene : m_setTaskQuenes) {
+    quene.clear();
+  }
+  m_nTaskNum = 0;
+}
+int CThreadPool::GetTaskNum() {
+  std::lock_guard<std::mutex> lck(m_mutTaskQuene);
+  return m_nTaskNum;
 }
-int CThreadPool::GetTaskNum() { return m_setTaskQuenes.size(); }
 
 }  // namespace hobot
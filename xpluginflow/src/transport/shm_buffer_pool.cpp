@@ -0,0 +1,210 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_buffer_pool.cpp
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    reference counted buffer pool placed in shared memory
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+#include "xpluginflow/transport/shm_buffer_pool.h"
+#include <new>
+#include <utility>
+#include "hobotlog/hobotlog.hpp"
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+namespace {
+const uint32_t kPoolMagic = 0x53484d50;  // "SHMP"
+const size_t kBlockAlign = 64;
+
+size_t AlignUp(size_t value, size_t align) {
+  return (value + align - 1) / align * align;
+}
+}  // namespace
+
+ShmBuffer::ShmBuffer(std::shared_ptr<ShmBufferPool> pool, uint32_t index)
+    : pool_(std::move(pool)), index_(index) {
+  data_ = pool_->Block(index);
+}
+
+ShmBuffer::ShmBuffer(const ShmBuffer &other)
+    : pool_(other.pool_), index_(other.index_), data_(other.data_) {
+  if (pool_) {
+    pool_->AddRef(index_);
+  }
+}
+
+ShmBuffer::ShmBuffer(ShmBuffer &&other)
+    : pool_(std::move(other.pool_)), index_(other.index_),
+      data_(other.data_) {
+  other.data_ = nullptr;
+}
+
+ShmBuffer &ShmBuffer::operator=(ShmBuffer other) {
+  std::swap(pool_, other.pool_);
+  std::swap(index_, other.index_);
+  std::swap(data_, other.data_);
+  return *this;
+}
+
+ShmBuffer::~ShmBuffer() {
+  if (pool_) {
+    pool_->Release(index_);
+  }
+}
+
+uint32_t ShmBuffer::size() const {
+  return pool_ ? pool_->block_size() : 0;
+}
+
+size_t ShmBufferPool::Size(uint32_t block_num, uint32_t block_size) {
+  size_t offset = AlignUp(sizeof(Header)
+                          + block_num * sizeof(std::atomic<uint64_t>),
+                          kBlockAlign);
+  return offset + static_cast<size_t>(block_num)
+      * AlignUp(block_size, kBlockAlign);
+}
+
+void ShmBufferPool::Init(void *mem, uint32_t block_num, uint32_t block_size,
+                         std::shared_ptr<void> owner) {
+  header_ = reinterpret_cast<Header *>(mem);
+  owner_ = std::move(owner);
+  header_->block_num = block_num;
+  header_->block_size = block_size;
+  header_->block_offset = static_cast<uint32_t>(
+      AlignUp(sizeof(Header) + block_num * sizeof(std::atomic<uint64_t>),
+              kBlockAlign));
+  side_ = 0;
+  for (uint32_t i = 0; i < block_num; i++) {
+    new (RefCount(i)) std::atomic<uint64_t>(0);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = kPoolMagic;
+}
+
+bool ShmBufferPool::Attach(void *mem, std::shared_ptr<void> owner) {
+  header_ = reinterpret_cast<Header *>(mem);
+  owner_ = std::move(owner);
+  side_ = 1;
+  bool ready = header_->magic == kPoolMagic;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return ready;
+}
+
+ShmBuffer ShmBufferPool::Allocate() {
+  uint32_t block_num = header_->block_num;
+  uint32_t start = next_.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < block_num; i++) {
+    uint32_t index = (start + i) % block_num;
+    uint64_t expected = 0;
+    if (RefCount(index)->compare_exchange_strong(
+            expected, Unit(side_), std::memory_order_acquire)) {
+      next_.store(index + 1, std::memory_order_relaxed);
+      return ShmBuffer(shared_from_this(), index);
+    }
+  }
+  LOGW << "no free shm buffer, block num = " << block_num;
+  return ShmBuffer();
+}
+
+ShmBuffer ShmBufferPool::Adopt(uint32_t index) {
+  if (index >= header_->block_num) {
+    LOGE << "invalid shm buffer " << index;
+    return ShmBuffer();
+  }
+  // move the reference from the handed over count to this side
+  auto ref = RefCount(index);
+  uint64_t state = ref->load(std::memory_order_relaxed);
+  do {
+    if (!(state & Mask(kHandover))) {
+      LOGE << "shm buffer " << index << " was not handed over";
+      return ShmBuffer();
+    }
+  } while (!ref->compare_exchange_weak(
+      state, state - Unit(kHandover) + Unit(side_),
+      std::memory_order_acquire));
+  return ShmBuffer(shared_from_this(), index);
+}
+
+uint32_t ShmBufferPool::Handover(const ShmBuffer &buffer) {
+  HOBOT_CHECK(buffer.pool_.get() == this) << "buffer of another pool";
+  RefCount(buffer.index())->fetch_add(Unit(kHandover),
+                                      std::memory_order_relaxed);
+  return buffer.index();
+}
+
+void ShmBufferPool::Revoke(uint32_t index) {
+  // the reference may be dropped by RevokeAll of the other side already
+  auto ref = RefCount(index);
+  uint64_t state = ref->load(std::memory_order_relaxed);
+  while ((state & Mask(kHandover))
+         && !ref->compare_exchange_weak(state, state - Unit(kHandover),
+                                        std::memory_order_release)) {
+  }
+}
+
+uint32_t ShmBufferPool::Reclaim(uint32_t side) {
+  HOBOT_CHECK(side < kHandover) << "invalid side " << side;
+  return Drop(Mask(side) | Mask(kHandover));
+}
+
+uint32_t ShmBufferPool::RevokeAll() {
+  return Drop(Mask(kHandover));
+}
+
+uint32_t ShmBufferPool::Drop(uint64_t mask) {
+  uint32_t dropped = 0;
+  for (uint32_t i = 0; i < header_->block_num; i++) {
+    auto ref = RefCount(i);
+    uint64_t state = ref->load(std::memory_order_relaxed);
+    while ((state & mask)
+           && !ref->compare_exchange_weak(state, state & ~mask,
+                                          std::memory_order_release)) {
+    }
+    for (uint32_t field = 0; field <= kHandover; field++) {
+      dropped += static_cast<uint32_t>((state & mask & Mask(field))
+                                       / Unit(field));
+    }
+  }
+  return dropped;
+}
+
+uint32_t ShmBufferPool::FreeCount() const {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < header_->block_num; i++) {
+    if (RefCount(i)->load(std::memory_order_relaxed) == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+std::atomic<uint64_t> *ShmBufferPool::RefCount(uint32_t index) const {
+  return reinterpret_cast<std::atomic<uint64_t> *>(header_ + 1) + index;
+}
+
+uint8_t *ShmBufferPool::Block(uint32_t index) const {
+  return reinterpret_cast<uint8_t *>(header_) + header_->block_offset
+      + static_cast<size_t>(index) * AlignUp(header_->block_size, kBlockAlign);
+}
+
+void ShmBufferPool::AddRef(uint32_t index) {
+  RefCount(index)->fetch_add(Unit(side_), std::memory_order_relaxed);
+}
+
+void ShmBufferPool::Release(uint32_t index) {
+  // release: the writes to the block happen before it is reused
+  RefCount(index)->fetch_sub(Unit(side_), std::memory_order_release);
+}
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
@@ -0,0 +1,117 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_region.cpp
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    named posix shared memory region
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+#include "xpluginflow/transport/shm_region.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "hobotlog/hobotlog.hpp"
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+ShmRegion::~ShmRegion() {
+  Close();
+}
+
+int ShmRegion::Create(const std::string &name, size_t size) {
+  Close();
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+  if (fd < 0) {
+    LOGE << "shm_open " << name << " failed: " << strerror(errno);
+    return -1;
+  }
+  if (ftruncate(fd, size) != 0) {
+    LOGE << "ftruncate " << name << " to " << size << " failed: "
+         << strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return -1;
+  }
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    LOGE << "mmap " << name << " failed: " << strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return -1;
+  }
+  name_ = name;
+  fd_ = fd;
+  data_ = data;
+  size_ = size;
+  owner_ = true;
+  LOGD << "create shm region " << name << ", size = " << size;
+  return 0;
+}
+
+int ShmRegion::Open(const std::string &name) {
+  Close();
+  int fd = shm_open(name.c_str(), O_RDWR, 0666);
+  if (fd < 0) {
+    LOGE << "shm_open " << name << " failed: " << strerror(errno);
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    LOGE << "invalid shm region " << name;
+    close(fd);
+    return -1;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    LOGE << "mmap " << name << " failed: " << strerror(errno);
+    close(fd);
+    return -1;
+  }
+  name_ = name;
+  fd_ = fd;
+  data_ = data;
+  size_ = size;
+  owner_ = false;
+  return 0;
+}
+
+void ShmRegion::Close() {
+  if (data_) {
+    munmap(data_, size_);
+    if (owner_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  fd_ = -1;
+  data_ = nullptr;
+  size_ = 0;
+  owner_ = false;
+}
+
+bool ShmRegion::Unlinked() const {
+  struct stat st;
+  if (fd_ < 0 || fstat(fd_, &st) != 0) {
+    return true;
+  }
+  return st.st_nlink == 0;
+}
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
@@ -0,0 +1,357 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     shm_transport.cpp
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    bridge of the message bus between processes of one board
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+#include "xpluginflow/transport/shm_transport.h"
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <utility>
+#include "hobotlog/hobotlog.hpp"
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+
+namespace {
+const uint32_t kChannelMagic = 0x53484d43;  // "SHMC"
+const size_t kRingOffset = 64;
+const int32_t kRecovering = -1;
+
+bool ProcessAlive(int32_t pid) {
+  return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+size_t AlignUp(size_t value, size_t align) {
+  return (value + align - 1) / align * align;
+}
+
+template <typename T>
+void Append(std::string *record, const T &value) {
+  record->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+bool Take(const std::string &record, size_t *pos, T *value) {
+  if (record.size() - *pos < sizeof(T)) {
+    return false;
+  }
+  memcpy(value, record.data() + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+}  // namespace
+
+int XShmChannel::Create(const std::string &name,
+                        const XShmChannelConfig &config) {
+  size_t pool_offset = AlignUp(kRingOffset + ShmRing::Size(config.ring_bytes),
+                               64);
+  size_t size = pool_offset
+      + ShmBufferPool::Size(config.block_num, config.block_size);
+  auto region = std::make_shared<ShmRegion>();
+  if (region->Create(name, size) != 0) {
+    return -1;
+  }
+  auto base = reinterpret_cast<uint8_t *>(region->data());
+  auto header = reinterpret_cast<Header *>(base);
+  new (&header->pid[0]) std::atomic<int32_t>(getpid());
+  new (&header->pid[1]) std::atomic<int32_t>(0);
+  ring_.Init(base + kRingOffset, config.ring_bytes);
+  pool_ = std::make_shared<ShmBufferPool>();
+  pool_->Init(base + pool_offset, config.block_num, config.block_size,
+              region);
+  header->pool_offset = pool_offset;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kChannelMagic;
+  region_ = region;
+  LOGI << "create shm channel " << name << ", ring bytes = "
+       << config.ring_bytes << ", blocks = " << config.block_num << " x "
+       << config.block_size;
+  return 0;
+}
+
+int XShmChannel::Open(const std::string &name) {
+  auto region = std::make_shared<ShmRegion>();
+  if (region->Open(name) != 0) {
+    return -1;
+  }
+  auto base = reinterpret_cast<uint8_t *>(region->data());
+  auto header = reinterpret_cast<Header *>(base);
+  bool ready = header->magic == kChannelMagic;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!ready || header->pool_offset >= region->size()) {
+    LOGE << "shm channel " << name << " is not ready";
+    return -1;
+  }
+  int32_t peer = 0;
+  if (!header->pid[1].compare_exchange_strong(peer, getpid())) {
+    if (peer > 0 && ProcessAlive(peer)) {
+      LOGE << "shm channel " << name << " is already open in process "
+           << peer;
+    } else {
+      LOGE << "shm channel " << name << " is not recovered from process "
+           << peer << " yet";
+    }
+    return -1;
+  }
+  ring_.Attach(base + kRingOffset);
+  pool_ = std::make_shared<ShmBufferPool>();
+  if (!pool_->Attach(base + header->pool_offset, region)) {
+    LOGE << "invalid buffer pool in shm channel " << name;
+    pool_ = nullptr;
+    header->pid[1].store(0);
+    return -1;
+  }
+  region_ = region;
+  return 0;
+}
+
+XShmChannel::~XShmChannel() {
+  if (region_ && pool_ && pool_->side() == 1) {
+    // a new process can open the channel
+    int32_t pid = getpid();
+    header()->pid[1].compare_exchange_strong(pid, 0);
+  }
+}
+
+bool XShmChannel::Reopen() {
+  XShmChannel channel;
+  if (channel.Open(region_->name()) != 0) {
+    return false;
+  }
+  // the old region stays mapped while buffers of its pool are alive, our
+  // pid is cleared there when channel is destroyed
+  std::swap(region_, channel.region_);
+  std::swap(ring_, channel.ring_);
+  std::swap(pool_, channel.pool_);
+  LOGW << "shm channel " << region_->name() << " was created again, reopened";
+  return true;
+}
+
+bool XShmChannel::CheckPeer() {
+  HOBOT_CHECK(region_) << "shm channel not created";
+  if (pool_->side() == 1 && region_->Unlinked()) {
+    // the messages and buffers of the old region are left to its mapping
+    return !Reopen();
+  }
+  uint32_t side = 1 - pool_->side();
+  auto &peer_pid = header()->pid[side];
+  int32_t pid = peer_pid.load();
+  if (pid <= 0 || ProcessAlive(pid) ||
+      !peer_pid.compare_exchange_strong(pid, kRecovering)) {
+    return true;
+  }
+  // the dead process neither pushes nor pops any more, its pending messages
+  // and the references it held are dropped
+  ring_.Reset();
+  uint32_t dropped = pool_->Reclaim(side);
+  peer_pid.store(0);
+  LOGW << "process " << pid << " of shm channel " << region_->name()
+       << " died, reclaimed " << dropped << " buffer references";
+  return false;
+}
+
+ShmBuffer XShmChannel::AllocBuffer() {
+  HOBOT_CHECK(pool_) << "shm channel not created";
+  auto buffer = pool_->Allocate();
+  if (!buffer && !CheckPeer()) {
+    buffer = pool_->Allocate();
+  }
+  return buffer;
+}
+
+bool XShmChannel::Send(const std::string &type, const ShmWriter &writer) {
+  HOBOT_CHECK(region_) << "shm channel not created";
+  // record: type, buffer indexes, payload
+  auto &record = send_record_;
+  record.clear();
+  Append(&record, static_cast<uint32_t>(type.size()));
+  record.append(type);
+  Append(&record, static_cast<uint32_t>(writer.buffers_.size()));
+  for (auto &buffer : writer.buffers_) {
+    if (!pool_->Owns(buffer)) {
+      LOGW << "buffer of a replaced region in shm channel "
+           << region_->name();
+      return false;
+    }
+  }
+  for (auto &buffer : writer.buffers_) {
+    // the receiver adopts this reference
+    Append(&record, pool_->Handover(buffer));
+  }
+  record.append(writer.payload_);
+  if (ring_.TryPush(record.data(), record.size())) {
+    return true;
+  }
+  for (auto &buffer : writer.buffers_) {
+    pool_->Revoke(buffer.index());
+  }
+  return false;
+}
+
+int XShmChannel::Receive(std::string *type, ShmReader *reader) {
+  HOBOT_CHECK(region_) << "shm channel not created";
+  auto &record = recv_record_;
+  bool corrupted = false;
+  if (!ring_.TryPop(&record, &corrupted)) {
+    if (corrupted) {
+      uint32_t dropped = pool_->RevokeAll();
+      LOGE << "corrupted record header in shm channel " << region_->name()
+           << ", pending records dropped, revoked " << dropped
+           << " buffer references";
+      return -1;
+    }
+    return 0;
+  }
+  size_t pos = 0;
+  uint32_t type_len = 0;
+  uint32_t buffer_num = 0;
+  bool ok = Take(record, &pos, &type_len)
+      && record.size() - pos >= type_len;
+  if (ok) {
+    type->assign(record, pos, type_len);
+    pos += type_len;
+    ok = Take(record, &pos, &buffer_num);
+  }
+  reader->buffers_.clear();
+  for (uint32_t i = 0; ok && i < buffer_num; i++) {
+    uint32_t index;
+    ok = Take(record, &pos, &index);
+    if (ok) {
+      reader->buffers_.push_back(pool_->Adopt(index));
+      ok = static_cast<bool>(reader->buffers_.back());
+    }
+  }
+  if (!ok) {
+    // the references handed over with the dropped records are never
+    // adopted, a record pushed meanwhile then fails to adopt its buffers
+    // and is dropped the same way
+    reader->buffers_.clear();
+    ring_.Reset();
+    uint32_t dropped = pool_->RevokeAll();
+    LOGE << "corrupted record in shm channel " << region_->name()
+         << ", pending records dropped, revoked " << dropped
+         << " buffer references";
+    return -1;
+  }
+  reader->payload_.assign(record, pos, std::string::npos);
+  reader->pos_ = 0;
+  reader->buffer_pos_ = 0;
+  return 1;
+}
+
+int XShmSender::Init() {
+  for (auto &type : types_) {
+    if (!XShmCodecRegistry::Instance().Get(type)) {
+      LOGW << "no shm codec for " << type << ", it will not be forwarded";
+    }
+    RegisterMsg(type);
+  }
+  return 0;
+}
+
+void XShmSender::OnMsg(XPluginFlowMessagePtr msg) {
+  auto codec = XShmCodecRegistry::Instance().Get(msg->type());
+  if (!codec) {
+    dropped_++;
+    return;
+  }
+  std::lock_guard<std::mutex> lck(mutex_);
+  ShmWriter writer;
+  if (!codec->encode(msg, &writer)) {
+    LOGW << "failed to encode " << msg->type();
+    dropped_++;
+    return;
+  }
+  if (!channel_->Send(msg->type(), writer)) {
+    // a ring that stays full may have lost its consumer
+    channel_->CheckPeer();
+    last_check_ = std::chrono::steady_clock::now();
+    LOGW << "shm channel full, drop " << msg->type();
+    dropped_++;
+    return;
+  }
+  sent_++;
+  // a restarted consumer does not fill the ring, look for it about every
+  // 100ms
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_check_ > std::chrono::milliseconds(100)) {
+    channel_->CheckPeer();
+    last_check_ = now;
+  }
+}
+
+int XShmReceiver::Start() {
+  if (!stop_) {
+    return 0;
+  }
+  stop_ = false;
+  thread_ = std::thread(&XShmReceiver::Loop, this);
+  return 0;
+}
+
+int XShmReceiver::Stop() {
+  if (stop_) {
+    return 0;
+  }
+  stop_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  return 0;
+}
+
+void XShmReceiver::Loop() {
+  std::string type;
+  int idle = 0;
+  while (!stop_) {
+    ShmReader reader;
+    int ret = channel_->Receive(&type, &reader);
+    if (ret < 0) {
+      continue;
+    }
+    if (ret == 0) {
+      // spin shortly, then poll every millisecond
+      if (++idle < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      // look for a dead producer about every 100ms
+      if (idle % 100 == 0) {
+        channel_->CheckPeer();
+      }
+      continue;
+    }
+    idle = 0;
+    received_++;
+    auto codec = XShmCodecRegistry::Instance().Get(type);
+    if (!codec) {
+      LOGW << "no shm codec for " << type;
+      continue;
+    }
+    auto msg = codec->decode(&reader);
+    if (msg) {
+      PushMsg(msg);
+    } else {
+      LOGW << "failed to decode " << type;
+    }
+  }
+}
+
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
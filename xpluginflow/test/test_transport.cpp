@@ -0,0 +1,340 @@
+/*!
+ * -------------------------------------------
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * \File     test_transport.cpp
+ * \Author   agent
+ * \Mail     agent@local
+ * \Version  1.0.0.0
+ * \Date     2026-10-19
+ * \Brief    test of the shared memory transport
+ * \DO NOT MODIFY THIS COMMENT, \
+ * \WHICH IS AUTO GENERATED BY EDITOR
+ * -------------------------------------------
+ */
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "xpluginflow/message/pluginflow/flowmsg.h"
+#include "xpluginflow/message/pluginflow/msg_registry.h"
+#include "xpluginflow/plugin/xpluginasync.h"
+#include "xpluginflow/transport/shm_transport.h"
+
+using std::chrono::milliseconds;
+using horizon::vision::xpluginflow::ShmBuffer;
+using horizon::vision::xpluginflow::ShmReader;
+using horizon::vision::xpluginflow::ShmRing;
+using horizon::vision::xpluginflow::ShmWriter;
+using horizon::vision::xpluginflow::XPluginAsync;
+using horizon::vision::xpluginflow::XPluginFlowMessage;
+using horizon::vision::xpluginflow::XPluginFlowMessagePtr;
+using horizon::vision::xpluginflow::XShmChannel;
+using horizon::vision::xpluginflow::XShmChannelConfig;
+using horizon::vision::xpluginflow::XShmCodec;
+using horizon::vision::xpluginflow::XShmCodecRegistry;
+using horizon::vision::xpluginflow::XShmReceiver;
+using horizon::vision::xpluginflow::XShmSender;
+
+namespace {
+
+TEST(shm_transport, ring) {
+  std::vector<uint64_t> mem(ShmRing::Size(256) / 8 + 8);
+  ShmRing producer, consumer;
+  producer.Init(mem.data(), 256);
+  consumer.Attach(mem.data());
+  std::string record;
+  EXPECT_FALSE(consumer.TryPop(&record));
+  EXPECT_FALSE(producer.TryPush(std::string(200, 'x').data(), 200));
+  // variable lengths, so the records wrap at different offsets
+  int pushed = 0, popped = 0;
+  for (int round = 0; round < 200; round++) {
+    while (true) {
+      std::string value(pushed % 37, static_cast<char>('a' + pushed % 26));
+      if (!producer.TryPush(value.data(), value.size())) {
+        break;
+      }
+      pushed++;
+    }
+    for (int i = 0; i < round % 3 + 1 && consumer.TryPop(&record); i++) {
+      EXPECT_EQ(record, std::string(popped % 37,
+                                    static_cast<char>('a' + popped % 26)));
+      popped++;
+    }
+  }
+  while (consumer.TryPop(&record)) {
+    popped++;
+  }
+  EXPECT_EQ(pushed, popped);
+  EXPECT_TRUE(consumer.Empty());
+
+  // a record length written wrong by the producer drops the pending records
+  ASSERT_TRUE(producer.TryPush("abc", 3));
+  ASSERT_TRUE(producer.TryPush("def", 3));
+  auto data = reinterpret_cast<uint8_t *>(mem.data())
+      + (ShmRing::Size(256) - 256);
+  for (size_t offset = 0; offset < 256; offset += 8) {
+    uint64_t len;
+    memcpy(&len, data + offset, sizeof(len));
+    if (len == 3 && memcmp(data + offset + 8, "abc", 3) == 0) {
+      len = 1000;
+      memcpy(data + offset, &len, sizeof(len));
+      break;
+    }
+  }
+  bool corrupted = false;
+  EXPECT_FALSE(consumer.TryPop(&record, &corrupted));
+  EXPECT_TRUE(corrupted);
+  EXPECT_TRUE(consumer.Empty());
+  EXPECT_TRUE(producer.TryPush("ghi", 3));
+  EXPECT_TRUE(consumer.TryPop(&record, &corrupted));
+  EXPECT_FALSE(corrupted);
+  EXPECT_EQ(record, "ghi");
+}
+
+#define TYPE_SHM_FRAME_MESSAGE "XPLUGIN_SHM_FRAME_MESSAGE"
+XPLUGIN_REGISTER_MSG_TYPE(XPLUGIN_SHM_FRAME_MESSAGE)
+
+struct ShmFrameMessage : XPluginFlowMessage {
+  ShmFrameMessage() { type_ = TYPE_SHM_FRAME_MESSAGE; }
+  std::string Serialize() override {
+    ADD_FAILURE() << "Serialize is not used on the board";
+    return std::string();
+  }
+  uint64_t frame_id = 0;
+  ShmBuffer image;
+};
+
+void RegisterFrameCodec() {
+  XShmCodec codec;
+  codec.encode = [](const XPluginFlowMessagePtr &msg, ShmWriter *writer) {
+    auto frame = std::static_pointer_cast<ShmFrameMessage>(msg);
+    writer->Put(frame->frame_id);
+    writer->PutBuffer(frame->image);
+    return true;
+  };
+  codec.decode = [](ShmReader *reader) -> XPluginFlowMessagePtr {
+    auto frame = std::make_shared<ShmFrameMessage>();
+    if (!reader->Get(&frame->frame_id) || !reader->GetBuffer(&frame->image)) {
+      return nullptr;
+    }
+    return frame;
+  };
+  XShmCodecRegistry::Instance().Register(TYPE_SHM_FRAME_MESSAGE, codec);
+}
+
+class FrameCollector : public XPluginAsync {
+ public:
+  int Init() override {
+    RegisterMsg(TYPE_SHM_FRAME_MESSAGE, [this](XPluginFlowMessagePtr msg) {
+      std::lock_guard<std::mutex> lck(mutex_);
+      frames_.push_back(std::static_pointer_cast<ShmFrameMessage>(msg));
+      return 0;
+    });
+    return XPluginAsync::Init();
+  }
+  size_t Count() {
+    std::lock_guard<std::mutex> lck(mutex_);
+    return frames_.size();
+  }
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<ShmFrameMessage>> frames_;
+};
+
+TEST(shm_transport, cross_process) {
+  RegisterFrameCodec();
+  std::string name = "/xpluginflow_test_" + std::to_string(getpid());
+  XShmChannelConfig config;
+  config.ring_bytes = 4096;
+  config.block_num = 4;
+  config.block_size = 64 * 1024;
+  auto channel = std::make_shared<XShmChannel>();
+  ASSERT_EQ(channel->Create(name, config), 0);
+
+  const int frame_num = 20;
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    // producer process, frames are written once into the shared blocks
+    auto sender_channel = std::make_shared<XShmChannel>();
+    if (sender_channel->Open(name) != 0) {
+      _exit(1);
+    }
+    XShmSender sender(sender_channel, {TYPE_SHM_FRAME_MESSAGE});
+    for (int i = 0; i < frame_num; i++) {
+      auto frame = std::make_shared<ShmFrameMessage>();
+      frame->frame_id = i;
+      while (!(frame->image = sender_channel->AllocBuffer())) {
+        std::this_thread::sleep_for(milliseconds(1));
+      }
+      memset(frame->image.data(), i, frame->image.size());
+      sender.OnMsg(frame);
+    }
+    _exit(sender.sent() == frame_num ? 0 : 2);
+  }
+
+  auto collector = std::make_shared<FrameCollector>();
+  collector->Init();
+  auto receiver = std::make_shared<XShmReceiver>(channel);
+  receiver->Init();
+  receiver->Start();
+  // the consumer releases the frames it has checked, so the producer can
+  // reuse the 4 blocks
+  size_t checked = 0;
+  for (int wait = 0; wait < 500 && checked < frame_num; wait++) {
+    std::this_thread::sleep_for(milliseconds(10));
+    std::lock_guard<std::mutex> lck(collector->mutex_);
+    for (; checked < collector->frames_.size(); checked++) {
+      auto &frame = collector->frames_[checked];
+      EXPECT_EQ(frame->frame_id, checked);
+      EXPECT_EQ(frame->image.data()[0], static_cast<uint8_t>(checked));
+      EXPECT_EQ(frame->image.data()[frame->image.size() - 1],
+                static_cast<uint8_t>(checked));
+      frame.reset();
+    }
+  }
+  receiver->Stop();
+  EXPECT_EQ(checked, frame_num);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+  EXPECT_EQ(channel->pool()->FreeCount(), config.block_num);
+}
+
+TEST(shm_transport, peer_crash) {
+  RegisterFrameCodec();
+  std::string name = "/xpluginflow_crash_" + std::to_string(getpid());
+  XShmChannelConfig config;
+  config.ring_bytes = 4096;
+  config.block_num = 4;
+  config.block_size = 4096;
+  auto channel = std::make_shared<XShmChannel>();
+  ASSERT_EQ(channel->Create(name, config), 0);
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    // holds every block, two of them also in messages, then crashes
+    XShmChannel sender_channel;
+    if (sender_channel.Open(name) != 0) {
+      _exit(1);
+    }
+    std::vector<ShmBuffer> buffers;
+    for (uint32_t i = 0; i < config.block_num; i++) {
+      buffers.push_back(sender_channel.AllocBuffer());
+    }
+    for (int i = 0; i < 2; i++) {
+      ShmWriter writer;
+      writer.Put(static_cast<uint64_t>(i));
+      writer.PutBuffer(buffers[i]);
+      sender_channel.Send(TYPE_SHM_FRAME_MESSAGE, writer);
+    }
+    raise(SIGKILL);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(channel->pool()->FreeCount(), 0u);
+  // a new process cannot take over before the buffers are reclaimed
+  auto other = std::make_shared<XShmChannel>();
+  EXPECT_NE(other->Open(name), 0);
+
+  EXPECT_FALSE(channel->CheckPeer());
+  EXPECT_TRUE(channel->CheckPeer());
+  EXPECT_EQ(channel->pool()->FreeCount(), config.block_num);
+  std::string type;
+  ShmReader reader;
+  EXPECT_EQ(channel->Receive(&type, &reader), 0);
+  EXPECT_EQ(other->Open(name), 0);
+}
+
+TEST(shm_transport, corrupted_record) {
+  std::string name = "/xpluginflow_corrupt_" + std::to_string(getpid());
+  XShmChannelConfig config;
+  config.ring_bytes = 4096;
+  config.block_num = 4;
+  config.block_size = 4096;
+  XShmChannel receiver;
+  ASSERT_EQ(receiver.Create(name, config), 0);
+  XShmChannel sender;
+  ASSERT_EQ(sender.Open(name), 0);
+  {
+    std::vector<ShmBuffer> buffers;
+    for (uint32_t i = 0; i < config.block_num; i++) {
+      buffers.push_back(sender.AllocBuffer());
+      ShmWriter writer;
+      writer.PutBuffer(buffers.back());
+      ASSERT_TRUE(sender.Send(TYPE_SHM_FRAME_MESSAGE, writer));
+    }
+    // the first record refers to a buffer that is not handed over any more
+    sender.pool()->Revoke(buffers[0].index());
+  }
+  std::string type;
+  ShmReader reader;
+  EXPECT_EQ(receiver.Receive(&type, &reader), -1);
+  EXPECT_EQ(receiver.Receive(&type, &reader), 0);
+  // the references of the 3 dropped records do not hold their blocks
+  EXPECT_EQ(receiver.pool()->FreeCount(), config.block_num);
+
+  ShmWriter writer;
+  writer.PutBuffer(sender.AllocBuffer());
+  ASSERT_TRUE(sender.Send(TYPE_SHM_FRAME_MESSAGE, writer));
+  EXPECT_EQ(receiver.Receive(&type, &reader), 1);
+}
+
+TEST(shm_transport, creator_restart) {
+  std::string name = "/xpluginflow_restart_" + std::to_string(getpid());
+  XShmChannelConfig config;
+  config.ring_bytes = 4096;
+  config.block_num = 2;
+  config.block_size = 4096;
+  auto creator = std::make_shared<XShmChannel>();
+  ASSERT_EQ(creator->Create(name, config), 0);
+  XShmChannel sender;
+  ASSERT_EQ(sender.Open(name), 0);
+  EXPECT_TRUE(sender.CheckPeer());
+  auto old_buffer = sender.AllocBuffer();
+  ASSERT_TRUE(old_buffer);
+
+  // the creator is gone, then comes back with a new region
+  creator.reset();
+  EXPECT_TRUE(sender.CheckPeer());
+  creator = std::make_shared<XShmChannel>();
+  ASSERT_EQ(creator->Create(name, config), 0);
+  EXPECT_FALSE(sender.CheckPeer());
+  EXPECT_TRUE(sender.CheckPeer());
+
+  // a buffer of the old region is not sent
+  ShmWriter stale;
+  stale.PutBuffer(old_buffer);
+  EXPECT_FALSE(sender.Send(TYPE_SHM_FRAME_MESSAGE, stale));
+
+  ShmWriter writer;
+  writer.Put(static_cast<uint64_t>(7));
+  auto buffer = sender.AllocBuffer();
+  ASSERT_TRUE(buffer);
+  buffer.data()[0] = 7;
+  writer.PutBuffer(buffer);
+  ASSERT_TRUE(sender.Send(TYPE_SHM_FRAME_MESSAGE, writer));
+  std::string type;
+  ShmReader reader;
+  ASSERT_EQ(creator->Receive(&type, &reader), 1);
+  EXPECT_EQ(type, TYPE_SHM_FRAME_MESSAGE);
+  uint64_t frame_id = 0;
+  ShmBuffer image;
+  EXPECT_TRUE(reader.Get(&frame_id));
+  EXPECT_EQ(frame_id, 7u);
+  ASSERT_TRUE(reader.GetBuffer(&image));
+  EXPECT_EQ(image.data()[0], 7);
+}
+
+}  // namespace
@@ -12,19 +12,30 @@
  * \WHICH IS AUTO GENERATED BY EDITOR
  * -------------------------------------------
  */
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <thread>
 #include "gtest/gtest.h"
 #include "hobotlog/hobotlog.hpp"
 #include "xpluginflow/message/pluginflow/flowmsg.h"
 #include "xpluginflow/plugin/xpluginasync.h"
 #include "xpluginflow/message/pluginflow/msg_registry.h"
+#include "xpluginflow/manager/msg_manager.h"
 
 using std::chrono::milliseconds;
 using horizon::vision::xpluginflow::XPluginAsync;
 using horizon::vision::xpluginflow::XPluginFlowMessage;
 using horizon::vision::xpluginflow::XPluginFlowMessagePtr;
+using horizon::vision::xpluginflow::XPlugin;
+using horizon::vision::xpluginflow::XMsgQueue;
+using horizon::vision::xpluginflow::XDispatchMode;
+using horizon::vision::xpluginflow::XMsgQueueConfig;
+using horizon::vision::xpluginflow::XMsgQueuePolicy;
+using horizon::vision::xpluginflow::XMsgQueueStats;
 
 namespace {
 
@@ -78,6 +89,235 @@ class TestVioPlugin : public XPluginAsync {
     }
   }
 };
+#define TYPE_COUNT_MESSAGE "XPLUGIN_COUNT_MESSAGE"
+XPLUGIN_REGISTER_MSG_TYPE(XPLUGIN_COUNT_MESSAGE)
+
+struct CountMessage : XPluginFlowMessage {
+  CountMessage() { type_ = TYPE_COUNT_MESSAGE; }
+  std::string Serialize() override { return std::string(); }
+};
+
+class CountPlugin : public XPluginAsync {
+ public:
+  int Init() override {
+    RegisterMsg(TYPE_COUNT_MESSAGE, [this](XPluginFlowMessagePtr msg) {
+      received_++;
+      return 0;
+    });
+    return XPluginAsync::Init();
+  }
+  void Unsubscribe() { UnRegisterMsg(TYPE_COUNT_MESSAGE); }
+  void Push() { PushMsg(std::make_shared<CountMessage>()); }
+  std::atomic<int> received_{0};
+};
+
+TEST(xpluginflow, unregister) {
+  auto plugin = std::make_shared<CountPlugin>();
+  plugin->Init();
+  for (int i = 0; i < 10; i++) {
+    plugin->Push();
+  }
+  for (int i = 0; i < 100 && plugin->received_ < 10; i++) {
+    std::this_thread::sleep_for(milliseconds(10));
+  }
+  EXPECT_EQ(plugin->received_, 10);
+
+  plugin->Unsubscribe();
+  for (int i = 0; i < 10; i++) {
+    plugin->Push();
+  }
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(plugin->received_, 10);
+}
+
+struct SeqMessage : CountMessage {
+  explicit SeqMessage(int seq) : seq_(seq) {}
+  int seq_;
+};
+
+class SeqPlugin : public XPlugin {
+ public:
+  explicit SeqPlugin(int delay_ms) : delay_ms_(delay_ms) {}
+  int Init() override { return 0; }
+  void OnMsg(XPluginFlowMessagePtr msg) override {
+    std::this_thread::sleep_for(milliseconds(delay_ms_));
+    int seq = std::static_pointer_cast<SeqMessage>(msg)->seq_;
+    if (seq != next_seq_) {
+      out_of_order_ = true;
+    }
+    next_seq_ = seq + 1;
+  }
+  int delay_ms_;
+  std::atomic<int> next_seq_{0};
+  std::atomic<bool> out_of_order_{false};
+};
+
+TEST(xpluginflow, dispatch_by_subscriber) {
+  XMsgQueue queue;
+  ASSERT_EQ(queue.SetDispatchThreads(4, XDispatchMode::BY_SUBSCRIBER), 0);
+  auto slow = std::make_shared<SeqPlugin>(20);
+  auto fast = std::make_shared<SeqPlugin>(0);
+  queue.RegisterPlugin(slow, TYPE_COUNT_MESSAGE);
+  queue.RegisterPlugin(fast, TYPE_COUNT_MESSAGE);
+  for (int i = 0; i < 20; i++) {
+    queue.PushMsg(std::make_shared<SeqMessage>(i));
+  }
+  EXPECT_EQ(queue.SetDispatchThreads(2), -1);
+  // the fast subscriber does not wait for the slow one
+  for (int i = 0; i < 100 && fast->next_seq_ < 20; i++) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  EXPECT_EQ(fast->next_seq_, 20);
+  EXPECT_LT(slow->next_seq_, 20);
+  for (int i = 0; i < 100 && slow->next_seq_ < 20; i++) {
+    std::this_thread::sleep_for(milliseconds(10));
+  }
+  EXPECT_EQ(slow->next_seq_, 20);
+  EXPECT_FALSE(fast->out_of_order_);
+  EXPECT_FALSE(slow->out_of_order_);
+}
+
+// the first message blocks the plugin thread until Release
+class GatePlugin : public XPluginAsync {
+ public:
+  explicit GatePlugin(XMsgQueuePolicy policy) : policy_(policy) {}
+  int Init() override {
+    XMsgQueueConfig config;
+    config.capacity = 3;
+    config.policy = policy_;
+    config.block_timeout_ms = 10;
+    RegisterMsg(TYPE_COUNT_MESSAGE, [this](XPluginFlowMessagePtr msg) {
+      std::unique_lock<std::mutex> lck(mutex_);
+      cond_.wait(lck, [this] { return released_; });
+      seqs_.push_back(std::static_pointer_cast<SeqMessage>(msg)->seq_);
+      return 0;
+    }, config);
+    return XPluginAsync::Init();
+  }
+  void Release() {
+    std::lock_guard<std::mutex> lck(mutex_);
+    released_ = true;
+    cond_.notify_all();
+  }
+  std::vector<int> Wait(size_t num) {
+    for (int i = 0; i < 100; i++) {
+      {
+        std::lock_guard<std::mutex> lck(mutex_);
+        if (seqs_.size() >= num) {
+          break;
+        }
+      }
+      std::this_thread::sleep_for(milliseconds(10));
+    }
+    std::lock_guard<std::mutex> lck(mutex_);
+    return seqs_;
+  }
+  XMsgQueuePolicy policy_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool released_ = false;
+  std::vector<int> seqs_;
+};
+
+static std::vector<int> RunQueuePolicy(XMsgQueuePolicy policy,
+                                       XMsgQueueStats *stats) {
+  auto plugin = std::make_shared<GatePlugin>(policy);
+  plugin->Init();
+  plugin->OnMsg(std::make_shared<SeqMessage>(0));
+  // wait for the plugin thread to take message 0
+  for (int i = 0; i < 100; i++) {
+    if (plugin->GetMsgQueueStats(TYPE_COUNT_MESSAGE).processed == 1) {
+      break;
+    }
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  for (int i = 1; i < 8; i++) {
+    plugin->OnMsg(std::make_shared<SeqMessage>(i));
+  }
+  *stats = plugin->GetMsgQueueStats(TYPE_COUNT_MESSAGE);
+  plugin->Release();
+  return plugin->Wait(stats->size + 1);
+}
+
+TEST(xpluginflow, msg_queue_policy) {
+  XMsgQueueStats stats;
+  auto seqs = RunQueuePolicy(XMsgQueuePolicy::DROP_NEWEST, &stats);
+  EXPECT_EQ(seqs, std::vector<int>({0, 1, 2, 3}));
+  EXPECT_EQ(stats.received, 8);
+  EXPECT_EQ(stats.dropped, 4);
+  EXPECT_EQ(stats.size, 3);
+  EXPECT_EQ(stats.peak_size, 3);
+
+  seqs = RunQueuePolicy(XMsgQueuePolicy::DROP_OLDEST, &stats);
+  EXPECT_EQ(seqs, std::vector<int>({0, 5, 6, 7}));
+  EXPECT_EQ(stats.dropped, 4);
+
+  seqs = RunQueuePolicy(XMsgQueuePolicy::COALESCE, &stats);
+  EXPECT_EQ(seqs, std::vector<int>({0, 7}));
+  EXPECT_EQ(stats.dropped, 6);
+  EXPECT_EQ(stats.size, 1);
+
+  seqs = RunQueuePolicy(XMsgQueuePolicy::BLOCK, &stats);
+  EXPECT_EQ(seqs, std::vector<int>({0, 1, 2, 3}));
+  EXPECT_EQ(stats.dropped, 4);
+}
+
+#define TYPE_CTRL_MESSAGE "XPLUGIN_CTRL_MESSAGE"
+XPLUGIN_REGISTER_CONTROL_MSG_TYPE(XPLUGIN_CTRL_MESSAGE)
+
+struct CtrlMessage : XPluginFlowMessage {
+  CtrlMessage() { type_ = TYPE_CTRL_MESSAGE; }
+  std::string Serialize() override { return std::string(); }
+};
+
+// records the messages in process order, the control message as -1
+class PriorityPlugin : public GatePlugin {
+ public:
+  PriorityPlugin() : GatePlugin(XMsgQueuePolicy::DROP_NEWEST) {}
+  int Init() override {
+    RegisterMsg(TYPE_CTRL_MESSAGE, [this](XPluginFlowMessagePtr msg) {
+      std::lock_guard<std::mutex> lck(mutex_);
+      seqs_.push_back(-1);
+      return 0;
+    });
+    return GatePlugin::Init();
+  }
+};
+
+TEST(xpluginflow, control_priority) {
+  auto plugin = std::make_shared<PriorityPlugin>();
+  plugin->Init();
+  plugin->OnMsg(std::make_shared<SeqMessage>(0));
+  for (int i = 0; i < 100; i++) {
+    if (plugin->GetMsgQueueStats(TYPE_COUNT_MESSAGE).processed == 1) {
+      break;
+    }
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  plugin->OnMsg(std::make_shared<SeqMessage>(1));
+  plugin->OnMsg(std::make_shared<SeqMessage>(2));
+  plugin->OnMsg(std::make_shared<CtrlMessage>());
+  plugin->Release();
+  // the control message runs right after the message being processed
+  EXPECT_EQ(plugin->Wait(4), std::vector<int>({0, -1, 1, 2}));
+}
+
+struct CountSerializeMessage : CountMessage {
+  std::string Serialize() override {
+    serialize_num++;
+    return "content";
+  }
+  int serialize_num = 0;
+};
+
+TEST(xpluginflow, serialized_data) {
+  auto msg = std::make_shared<CountSerializeMessage>();
+  auto data = msg->SerializedData();
+  EXPECT_EQ(*data, "content");
+  EXPECT_EQ(msg->SerializedData(), data);
+  EXPECT_EQ(msg->serialize_num, 1);
+}
+
 TEST(xpluginflow, xplugin) {
   SetLogLevel(HOBOT_LOG_DEBUG);
   auto vio_plugin = std::make_shared<TestVioPlugin>();
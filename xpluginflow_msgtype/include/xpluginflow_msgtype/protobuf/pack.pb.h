@@ -69,12 +69,13 @@ enum MessagePack_Type {
   MessagePack_Type_kUnknown = 0,
   MessagePack_Type_kXPlugin = 1,
   MessagePack_Type_kXConfig = 2,
+  MessagePack_Type_kXPluginCompact = 3,
   MessagePack_Type_MessagePack_Type_INT_MIN_SENTINEL_DO_NOT_USE_ = ::google::protobuf::kint32min,
   MessagePack_Type_MessagePack_Type_INT_MAX_SENTINEL_DO_NOT_USE_ = ::google::protobuf::kint32max
 };
 bool MessagePack_Type_IsValid(int value);
 const MessagePack_Type MessagePack_Type_Type_MIN = MessagePack_Type_kUnknown;
-const MessagePack_Type MessagePack_Type_Type_MAX = MessagePack_Type_kXConfig;
+const MessagePack_Type MessagePack_Type_Type_MAX = MessagePack_Type_kXPluginCompact;
 const int MessagePack_Type_Type_ARRAYSIZE = MessagePack_Type_Type_MAX + 1;
 
 // ===================================================================
@@ -497,6 +498,8 @@ class MessagePack : public ::google::protobuf::MessageLite /* @@protoc_insertion
     MessagePack_Type_kXPlugin;
   static const Type kXConfig =
     MessagePack_Type_kXConfig;
+  static const Type kXPluginCompact =
+    MessagePack_Type_kXPluginCompact;
   static inline bool Type_IsValid(int value) {
     return MessagePack_Type_IsValid(value);
   }
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * @Author: agent
+ * @Mail: agent@local
+ * @Date: 2026-10-19
+ * @Version: v0.0.1
+ * @Brief: compact binary encoding of smart results.
+ */
+
+#ifndef XPLUGINFLOW_MSGTYPE_SMART_COMPACT_H_
+#define XPLUGINFLOW_MSGTYPE_SMART_COMPACT_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+namespace basic_msgtype {
+
+// target types, replacing the type_ strings of x2::Target
+enum CompactTargetType : uint8_t {
+  kCompactUnknown = 0,
+  kCompactFace = 1,
+  kCompactHead = 2,
+  kCompactBody = 3,
+  kCompactLmk = 4,
+  kCompactKps = 5
+};
+
+// attribute types, replacing the type_ strings of x2::Attributes
+enum CompactAttrType : uint8_t {
+  kCompactAge = 1,
+  kCompactGender = 2
+};
+
+struct CompactPoint {
+  float x = 0;
+  float y = 0;
+  float score = 0;
+};
+
+struct CompactAttr {
+  uint8_t type = 0;
+  int32_t value = 0;
+  float score = 0;
+};
+
+struct CompactTarget {
+  uint8_t type = kCompactUnknown;
+  int32_t track_id = 0;
+  bool has_box = false;
+  // top left and bottom right
+  CompactPoint box[2];
+  std::vector<CompactPoint> points;
+  std::vector<CompactAttr> attrs;
+};
+
+struct CompactFrame {
+  uint64_t frame_id = 0;
+  uint64_t timestamp = 0;
+  std::vector<CompactTarget> targets;
+};
+
+/**
+ * Frame layout (varints, signed values zigzag coded):
+ *   version, flags(bit0 keyframe), frame_id, timestamp, target num, targets
+ * Target:
+ *   type, track_id, field mask(bit0 box, bit1 points, bit2 attrs),
+ *   [box: 2 points], [point num, points], [changed attr num, attrs]
+ * Coordinates are fixed point of 1/4 pixel and scores of 1/256. Outside
+ * keyframes, coordinates are deltas against the same target in the last
+ * frame and only changed attributes are sent. A target is matched by
+ * (type, track_id, n-th occurrence of that pair in the frame).
+ */
+class CompactState {
+ public:
+  typedef std::tuple<uint8_t, int32_t, uint32_t> Key;
+  struct Quantized {
+    bool has_box = false;
+    int32_t box[6] = {0};
+    std::vector<int32_t> points;
+    std::map<uint8_t, std::pair<int32_t, int32_t>> attrs;
+  };
+  std::map<Key, Quantized> targets;
+};
+
+class SmartCompactEncoder {
+ public:
+  // a keyframe every keyframe_interval frames, 0 for the first frame only
+  explicit SmartCompactEncoder(uint32_t keyframe_interval = 25)
+      : keyframe_interval_(keyframe_interval) {}
+
+  void Encode(const CompactFrame &frame, std::string *out);
+  // the next frame is a keyframe, e.g. after a send failure
+  void ForceKeyframe() { force_keyframe_ = true; }
+
+ private:
+  uint32_t keyframe_interval_;
+  uint32_t since_keyframe_ = 0;
+  bool force_keyframe_ = true;
+  CompactState state_;
+};
+
+class SmartCompactDecoder {
+ public:
+  // false on a malformed frame or a delta frame without its keyframe
+  bool Decode(const std::string &data, CompactFrame *frame);
+
+ private:
+  bool synced_ = false;
+  CompactState state_;
+};
+
+}  // namespace basic_msgtype
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
+
+#endif  // XPLUGINFLOW_MSGTYPE_SMART_COMPACT_H_
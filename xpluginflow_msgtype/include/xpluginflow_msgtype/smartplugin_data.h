@@ -14,6 +14,7 @@
 #define XPLUGINFLOW_MSGTYPE_SMARTPLUGIN_DATA_H_
 
 #include "xpluginflow/message/pluginflow/flowmsg.h"
+#include "xpluginflow_msgtype/smart_compact.h"
 
 namespace horizon {
 namespace vision {
@@ -29,6 +30,8 @@ struct SmartMessage : XPluginFlowMessage {
   virtual ~SmartMessage() = default;
 
   std::string Serialize() override { return "Default smart message"; };
+  // 转换为紧凑编码的输入, 不支持时返回false, 使用Serialize()的结果
+  virtual bool GetCompactFrame(CompactFrame *frame) { return false; }
 };
 
 }  // namespace basic_msgtype
@@ -1000,6 +1000,7 @@ bool MessagePack_Type_IsValid(int value) {
     case 0:
     case 1:
     case 2:
+    case 3:
       return true;
     default:
       return false;
@@ -1010,6 +1011,7 @@ bool MessagePack_Type_IsValid(int value) {
 const MessagePack_Type MessagePack::kUnknown;
 const MessagePack_Type MessagePack::kXPlugin;
 const MessagePack_Type MessagePack::kXConfig;
+const MessagePack_Type MessagePack::kXPluginCompact;
 const MessagePack_Type MessagePack::Type_MIN;
 const MessagePack_Type MessagePack::Type_MAX;
 const int MessagePack::Type_ARRAYSIZE;
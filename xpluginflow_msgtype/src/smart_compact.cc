@@ -0,0 +1,321 @@
+/**
+ * Copyright (c) 2026, Horizon Robotics, Inc.
+ * All rights reserved.
+ * @Author: agent
+ * @Mail: agent@local
+ * @Date: 2026-10-19
+ * @Version: v0.0.1
+ * @Brief: compact binary encoding of smart results.
+ */
+
+#include "xpluginflow_msgtype/smart_compact.h"
+
+#include <cmath>
+#include <utility>
+
+namespace horizon {
+namespace vision {
+namespace xpluginflow {
+namespace basic_msgtype {
+
+namespace {
+const uint8_t kCompactVersion = 1;
+const uint8_t kFlagKeyframe = 1;
+const uint8_t kMaskBox = 1;
+const uint8_t kMaskPoints = 2;
+const uint8_t kMaskAttrs = 4;
+// attribute entry removing the attribute from the target
+const uint8_t kAttrRemoved = 0x80;
+
+int32_t Coord(float value) {
+  return static_cast<int32_t>(std::lround(value * 4));
+}
+int32_t Score(float value) {
+  return static_cast<int32_t>(std::lround(value * 256));
+}
+
+void PutVarint(uint64_t value, std::string *out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutSigned(int64_t value, std::string *out) {
+  PutVarint((static_cast<uint64_t>(value) << 1) ^ (value >> 63), out);
+}
+
+class Reader {
+ public:
+  explicit Reader(const std::string &data) : data_(data) {}
+  bool GetVarint(uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) {
+        return false;
+      }
+      uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool GetSigned(int64_t *value) {
+    uint64_t raw;
+    if (!GetVarint(&raw)) {
+      return false;
+    }
+    *value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+  }
+  template <typename T>
+  bool GetSigned32(T *value) {
+    int64_t raw;
+    if (!GetSigned(&raw)) {
+      return false;
+    }
+    *value = static_cast<T>(raw);
+    return true;
+  }
+  bool GetByte(uint8_t *value) {
+    if (pos_ >= data_.size()) {
+      return false;
+    }
+    *value = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+  bool End() const { return pos_ == data_.size(); }
+
+ private:
+  const std::string &data_;
+  size_t pos_ = 0;
+};
+
+CompactState::Quantized Quantize(const CompactTarget &target) {
+  CompactState::Quantized q;
+  q.has_box = target.has_box;
+  if (target.has_box) {
+    for (int i = 0; i < 2; i++) {
+      q.box[i * 3] = Coord(target.box[i].x);
+      q.box[i * 3 + 1] = Coord(target.box[i].y);
+      q.box[i * 3 + 2] = Score(target.box[i].score);
+    }
+  }
+  q.points.reserve(target.points.size() * 3);
+  for (auto &point : target.points) {
+    q.points.push_back(Coord(point.x));
+    q.points.push_back(Coord(point.y));
+    q.points.push_back(Score(point.score));
+  }
+  for (auto &attr : target.attrs) {
+    q.attrs[attr.type] = std::make_pair(attr.value, Score(attr.score));
+  }
+  return q;
+}
+
+CompactPoint Dequantize(const int32_t *values) {
+  CompactPoint point;
+  point.x = values[0] / 4.f;
+  point.y = values[1] / 4.f;
+  point.score = values[2] / 256.f;
+  return point;
+}
+
+// n-th occurrence of (type, track_id) in the frame
+CompactState::Key MakeKey(
+    uint8_t type, int32_t track_id,
+    std::map<std::pair<uint8_t, int32_t>, uint32_t> *occurrence) {
+  auto &count = (*occurrence)[std::make_pair(type, track_id)];
+  return std::make_tuple(type, track_id, count++);
+}
+}  // namespace
+
+void SmartCompactEncoder::Encode(const CompactFrame &frame,
+                                 std::string *out) {
+  bool keyframe = force_keyframe_
+      || (keyframe_interval_ > 0 && since_keyframe_ + 1 >= keyframe_interval_);
+  force_keyframe_ = false;
+  since_keyframe_ = keyframe ? 0 : since_keyframe_ + 1;
+
+  out->clear();
+  out->push_back(static_cast<char>(kCompactVersion));
+  out->push_back(static_cast<char>(keyframe ? kFlagKeyframe : 0));
+  PutVarint(frame.frame_id, out);
+  PutVarint(frame.timestamp, out);
+  PutVarint(frame.targets.size(), out);
+
+  CompactState next;
+  std::map<std::pair<uint8_t, int32_t>, uint32_t> occurrence;
+  static const CompactState::Quantized kEmpty{};
+  for (auto &target : frame.targets) {
+    auto key = MakeKey(target.type, target.track_id, &occurrence);
+    auto q = Quantize(target);
+    const CompactState::Quantized *prev = &kEmpty;
+    if (!keyframe) {
+      auto iter = state_.targets.find(key);
+      if (iter != state_.targets.end()) {
+        prev = &iter->second;
+      }
+    }
+
+    // changed attributes, and the removed ones as kAttrRemoved entries
+    std::vector<std::pair<uint8_t, std::pair<int32_t, int32_t>>> changed;
+    for (auto &attr : q.attrs) {
+      auto iter = prev->attrs.find(attr.first);
+      if (iter == prev->attrs.end() || iter->second != attr.second) {
+        changed.push_back(attr);
+      }
+    }
+    for (auto &attr : prev->attrs) {
+      if (!q.attrs.count(attr.first)) {
+        changed.push_back(std::make_pair(attr.first | kAttrRemoved,
+                                         std::make_pair(0, 0)));
+      }
+    }
+
+    out->push_back(static_cast<char>(target.type));
+    PutSigned(target.track_id, out);
+    uint8_t mask = (q.has_box ? kMaskBox : 0)
+        | (q.points.empty() ? 0 : kMaskPoints)
+        | (changed.empty() ? 0 : kMaskAttrs);
+    out->push_back(static_cast<char>(mask));
+    if (q.has_box) {
+      for (int i = 0; i < 6; i++) {
+        PutSigned(static_cast<int64_t>(q.box[i])
+                  - (prev->has_box ? prev->box[i] : 0), out);
+      }
+    }
+    if (!q.points.empty()) {
+      PutVarint(q.points.size() / 3, out);
+      for (size_t i = 0; i < q.points.size(); i++) {
+        int32_t base = i < prev->points.size() ? prev->points[i] : 0;
+        PutSigned(static_cast<int64_t>(q.points[i]) - base, out);
+      }
+    }
+    if (!changed.empty()) {
+      PutVarint(changed.size(), out);
+      for (auto &attr : changed) {
+        out->push_back(static_cast<char>(attr.first));
+        if (!(attr.first & kAttrRemoved)) {
+          PutSigned(attr.second.first, out);
+          PutSigned(attr.second.second, out);
+        }
+      }
+    }
+    next.targets[key] = std::move(q);
+  }
+  state_ = std::move(next);
+}
+
+bool SmartCompactDecoder::Decode(const std::string &data,
+                                 CompactFrame *frame) {
+  Reader reader(data);
+  uint8_t version, flags;
+  uint64_t target_num;
+  if (!reader.GetByte(&version) || version != kCompactVersion
+      || !reader.GetByte(&flags) || !reader.GetVarint(&frame->frame_id)
+      || !reader.GetVarint(&frame->timestamp)
+      || !reader.GetVarint(&target_num) || target_num > data.size()) {
+    synced_ = false;
+    return false;
+  }
+  bool keyframe = flags & kFlagKeyframe;
+  if (!keyframe && !synced_) {
+    return false;
+  }
+
+  CompactState next;
+  std::map<std::pair<uint8_t, int32_t>, uint32_t> occurrence;
+  static const CompactState::Quantized kEmpty{};
+  frame->targets.resize(target_num);
+  bool ok = true;
+  for (uint64_t t = 0; ok && t < target_num; t++) {
+    auto &target = frame->targets[t];
+    uint8_t mask;
+    ok = reader.GetByte(&target.type) && reader.GetSigned32(&target.track_id)
+        && reader.GetByte(&mask);
+    if (!ok) {
+      break;
+    }
+    auto key = MakeKey(target.type, target.track_id, &occurrence);
+    const CompactState::Quantized *prev = &kEmpty;
+    if (!keyframe) {
+      auto iter = state_.targets.find(key);
+      if (iter != state_.targets.end()) {
+        prev = &iter->second;
+      }
+    }
+    CompactState::Quantized q;
+    q.has_box = mask & kMaskBox;
+    for (int i = 0; ok && q.has_box && i < 6; i++) {
+      int64_t delta;
+      ok = reader.GetSigned(&delta);
+      q.box[i] = static_cast<int32_t>(delta
+                                      + (prev->has_box ? prev->box[i] : 0));
+    }
+    uint64_t point_num = 0;
+    if (ok && (mask & kMaskPoints)) {
+      ok = reader.GetVarint(&point_num) && point_num <= data.size();
+    }
+    for (uint64_t i = 0; ok && i < point_num * 3; i++) {
+      int64_t delta;
+      ok = reader.GetSigned(&delta);
+      int32_t base = i < prev->points.size() ? prev->points[i] : 0;
+      q.points.push_back(static_cast<int32_t>(delta + base));
+    }
+    q.attrs = prev->attrs;
+    uint64_t attr_num = 0;
+    if (ok && (mask & kMaskAttrs)) {
+      ok = reader.GetVarint(&attr_num) && attr_num <= data.size();
+    }
+    for (uint64_t i = 0; ok && i < attr_num; i++) {
+      uint8_t type;
+      ok = reader.GetByte(&type);
+      if (ok && (type & kAttrRemoved)) {
+        q.attrs.erase(type & ~kAttrRemoved);
+      } else if (ok) {
+        std::pair<int32_t, int32_t> value;
+        ok = reader.GetSigned32(&value.first)
+            && reader.GetSigned32(&value.second);
+        q.attrs[type] = value;
+      }
+    }
+    if (!ok) {
+      break;
+    }
+
+    target.has_box = q.has_box;
+    if (q.has_box) {
+      target.box[0] = Dequantize(q.box);
+      target.box[1] = Dequantize(q.box + 3);
+    }
+    target.points.clear();
+    for (size_t i = 0; i + 2 < q.points.size(); i += 3) {
+      target.points.push_back(Dequantize(&q.points[i]));
+    }
+    target.attrs.clear();
+    for (auto &attr : q.attrs) {
+      CompactAttr compact_attr;
+      compact_attr.type = attr.first;
+      compact_attr.value = attr.second.first;
+      compact_attr.score = attr.second.second / 256.f;
+      target.attrs.push_back(compact_attr);
+    }
+    next.targets[key] = std::move(q);
+  }
+  if (!ok || !reader.End()) {
+    synced_ = false;
+    return false;
+  }
+  state_ = std::move(next);
+  synced_ = true;
+  return true;
+}
+
+}  // namespace basic_msgtype
+}  // namespace xpluginflow
+}  // namespace vision
+}  // namespace horizon
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @file task_group.h
+ * @brief fixed worker threads running a batch of tasks
+ * @author agent
+ * @email agent@local
+ * @date 2026/10/19
+ */
+
+#ifndef INCLUDE_COMMON_TASK_GROUP_H_
+#define INCLUDE_COMMON_TASK_GROUP_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HobotXRoc {
+
+// fixed set of worker threads running a batch of tasks together with the
+// calling thread. Run blocks until every task of the batch has finished.
+// Not reentrant, one batch at a time.
+class TaskGroup {
+ public:
+  // thread_num includes the calling thread, so thread_num - 1 workers
+  explicit TaskGroup(int thread_num);
+  ~TaskGroup();
+
+  void Run(const std::vector<std::function<void()>> &tasks);
+
+  int ThreadNum() const { return static_cast<int>(workers_.size()) + 1; }
+
+ private:
+  void WorkerLoop();
+  // run tasks of the current batch until none is left, lock must be held
+  void Drain(std::unique_lock<std::mutex> &lock);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  const std::vector<std::function<void()>> *tasks_ = nullptr;
+  size_t next_task_ = 0;
+  size_t finished_task_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace HobotXRoc
+
+#endif  // INCLUDE_COMMON_TASK_GROUP_H_
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @brief compact (int8/fp16) l2 normalized feature shared by the methods
+ * and the plugins
+ * @file compact_feature.h
+ * @author    agent
+ * @email     agent@local
+ * @version   0.0.0.1
+ * @date      2026.10.19
+ */
+
+#ifndef HOBOTXSDK_COMPACT_FEATURE_H_
+#define HOBOTXSDK_COMPACT_FEATURE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace HobotXRoc {
+
+// BaseData::type_ of XRocData<CompactFeature>
+#define COMPACT_FEATURE_TYPE "CompactFeature"
+
+/**
+ * l2 normalized feature stored in int8 (value = data[i] * scale) or
+ * fp16 (ieee half, native endian), used instead of hobot::vision::Feature
+ * when "feature_format" of the face_feature CNNMethod is int8/fp16.
+ */
+struct CompactFeature {
+  enum class Format { INT8, FP16 };
+
+  Format format = Format::INT8;
+  int32_t dim = 0;
+  /// only for int8
+  float scale = 0.0f;
+  /// dim bytes for int8, 2 * dim bytes for fp16
+  std::vector<uint8_t> data;
+  float score = 0.0f;
+
+  /// 1 / l2 norm of src, and the largest absolute value when max_abs is set
+  static float InvNorm(const float *src, int32_t dim,
+                       float *max_abs = nullptr) {
+    float sum = 0.0f;
+    float max_value = 0.0f;
+    for (int32_t i = 0; i < dim; i++) {
+      sum += src[i] * src[i];
+      max_value = std::max(max_value, std::fabs(src[i]));
+    }
+    if (max_abs) {
+      *max_abs = max_value;
+    }
+    return 1.0f / (std::sqrt(sum) + 1e-10f);
+  }
+
+  /// l2 normalize src into dst (may be src)
+  static void Normalize(const float *src, int32_t dim, float *dst) {
+    const float inv_norm = InvNorm(src, dim);
+    for (int32_t i = 0; i < dim; i++) {
+      dst[i] = src[i] * inv_norm;
+    }
+  }
+
+  /// l2 normalize src and encode it in one pass over the output
+  void Encode(const float *src, int32_t src_dim, Format src_format) {
+    float max_abs = 0.0f;
+    const float inv_norm = InvNorm(src, src_dim, &max_abs);
+    format = src_format;
+    dim = src_dim;
+    if (format == Format::INT8) {
+      scale = max_abs * inv_norm / 127.0f;
+      data.resize(dim);
+      auto dst = reinterpret_cast<int8_t *>(data.data());
+      const float quant = scale > 0 ? inv_norm / scale : 0.0f;
+      for (int32_t i = 0; i < dim; i++) {
+        dst[i] = static_cast<int8_t>(std::lround(src[i] * quant));
+      }
+    } else {
+      scale = 0.0f;
+      data.resize(dim * sizeof(uint16_t));
+      auto dst = reinterpret_cast<uint16_t *>(data.data());
+      for (int32_t i = 0; i < dim; i++) {
+        dst[i] = FloatToHalf(src[i] * inv_norm);
+      }
+    }
+  }
+
+  static uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int32_t exp = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = bits & 0x7fffff;
+    if (exp <= 0) {
+      // too small for a normal half, flush to signed zero
+      return sign;
+    }
+    if (exp >= 0x1f) {
+      return sign | 0x7c00;
+    }
+    // round to nearest
+    uint16_t half = sign | (exp << 10) | (mant >> 13);
+    if (mant & 0x1000) {
+      half++;
+    }
+    return half;
+  }
+
+  static float HalfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exp = (half >> 10) & 0x1f;
+    uint32_t mant = half & 0x3ff;
+    uint32_t bits;
+    if (exp == 0) {
+      bits = sign;
+    } else if (exp == 0x1f) {
+      bits = sign | 0x7f800000 | (mant << 13);
+    } else {
+      bits = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  void ToFloat(std::vector<float> *values) const {
+    values->resize(dim);
+    if (format == Format::INT8) {
+      auto q = reinterpret_cast<const int8_t *>(data.data());
+      for (int32_t i = 0; i < dim; i++) {
+        (*values)[i] = q[i] * scale;
+      }
+    } else {
+      auto h = reinterpret_cast<const uint16_t *>(data.data());
+      for (int32_t i = 0; i < dim; i++) {
+        (*values)[i] = HalfToFloat(h[i]);
+      }
+    }
+  }
+};
+
+}  // namespace HobotXRoc
+#endif  // HOBOTXSDK_COMPACT_FEATURE_H_
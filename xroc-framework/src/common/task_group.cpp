@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2026 Horizon Robotics. All rights reserved.
+ * @file task_group.cpp
+ * @brief fixed worker threads running a batch of tasks
+ * @author agent
+ * @email agent@local
+ * @date 2026/10/19
+ */
+
+#include "common/task_group.h"
+
+namespace HobotXRoc {
+
+TaskGroup::TaskGroup(int thread_num) {
+  for (int i = 1; i < thread_num; ++i) {
+    workers_.emplace_back(&TaskGroup::WorkerLoop, this);
+  }
+}
+
+TaskGroup::~TaskGroup() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void TaskGroup::Run(const std::vector<std::function<void()>> &tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  if (workers_.empty() || tasks.size() == 1) {
+    for (auto &task : tasks) {
+      task();
+    }
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  tasks_ = &tasks;
+  next_task_ = 0;
+  finished_task_ = 0;
+  task_cv_.notify_all();
+  Drain(lock);
+  done_cv_.wait(lock, [&] { return finished_task_ == tasks.size(); });
+  tasks_ = nullptr;
+}
+
+void TaskGroup::Drain(std::unique_lock<std::mutex> &lock) {
+  while (tasks_ && next_task_ < tasks_->size()) {
+    const auto &task = (*tasks_)[next_task_++];
+    lock.unlock();
+    task();
+    lock.lock();
+    if (++finished_task_ == tasks_->size()) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+void TaskGroup::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    task_cv_.wait(lock, [this] {
+      return stop_ || (tasks_ && next_task_ < tasks_->size());
+    });
+    if (stop_) {
+      return;
+    }
+    Drain(lock);
+  }
+}
+
+}  // namespace HobotXRoc